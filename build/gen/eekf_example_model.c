@@ -0,0 +1,141 @@
+/* generated by eekf_gen, do not edit */
+
+#include "eekf_example_model.h"
+
+#include <eekf/eekf_publish.h>
+
+#include <stddef.h>
+#include <math.h>
+
+#define P_(r, c) (*EEKF_MAT_EL(*ctx->P, (r), (c)))
+#define X_(r) (*EEKF_MAT_EL(*ctx->x, (r), 0))
+
+eekf_return eekf_example_model_predict(eekf_context *ctx, eekf_mat const *u,
+        eekf_mat const *Q)
+{
+    if (NULL == ctx || NULL == u || NULL == Q || 2 != ctx->x->rows
+            || 2 != Q->rows || 2 != Q->cols)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    EEKF_DECL_MAT(Jf, 2, 2);
+    EEKF_DECL_MAT(xp, 2, 1);
+    eekf_value T[2][2];
+    eekf_acc acc;
+
+    // predict state and linearize system: x1 = f(x,u), Jf = df(x,u)/dx
+    if (NULL != ctx->f
+            && eEekfReturnOk != ctx->f(&xp, &Jf, ctx->x, u, ctx->userData))
+    {
+        return eEekfReturnCallbackFailed;
+    }
+    X_(0) = *EEKF_MAT_EL(xp, 0, 0);
+    X_(1) = *EEKF_MAT_EL(xp, 1, 0);
+
+    // T = Jf * P
+    acc = 0;
+    acc = EEKF_MAC(acc, P_(0, 0), EEKF_VALUE(1));
+    acc = EEKF_MAC(acc, P_(1, 0), *EEKF_MAT_EL(Jf, 0, 1));
+    T[0][0] = EEKF_ACC_VALUE(acc);
+    acc = 0;
+    acc = EEKF_MAC(acc, P_(0, 1), EEKF_VALUE(1));
+    acc = EEKF_MAC(acc, P_(1, 1), *EEKF_MAT_EL(Jf, 0, 1));
+    T[0][1] = EEKF_ACC_VALUE(acc);
+    T[1][0] = P_(1, 0);
+    T[1][1] = P_(1, 1);
+
+    // P = T * Jf' + Q
+    acc = EEKF_ACC(*EEKF_MAT_EL(*Q, 0, 0));
+    acc = EEKF_MAC(acc, T[0][0], EEKF_VALUE(1));
+    acc = EEKF_MAC(acc, T[0][1], *EEKF_MAT_EL(Jf, 0, 1));
+    P_(0, 0) = EEKF_ACC_VALUE(acc);
+    acc = EEKF_ACC(*EEKF_MAT_EL(*Q, 0, 1));
+    acc = EEKF_MAC(acc, T[0][1], EEKF_VALUE(1));
+    P_(0, 1) = EEKF_ACC_VALUE(acc);
+    P_(1, 0) = P_(0, 1);
+    acc = EEKF_ACC(*EEKF_MAT_EL(*Q, 1, 1));
+    acc = EEKF_MAC(acc, T[1][1], EEKF_VALUE(1));
+    P_(1, 1) = EEKF_ACC_VALUE(acc);
+
+    (void) acc;
+    eekf_publish_step(ctx->publish, ctx->x, ctx->P);
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_example_model_correct(eekf_context *ctx, eekf_mat const *z,
+        eekf_mat const *R)
+{
+    if (NULL == ctx || NULL == z || NULL == R || 2 != ctx->x->rows
+            || 1 != z->rows || 1 != R->rows || 1 != R->cols)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    EEKF_DECL_MAT(Jh, 1, 2);
+    EEKF_DECL_MAT(zp, 1, 1);
+    eekf_value C[2][1];
+    eekf_value S[1][1];
+    eekf_value L[1][1];
+    eekf_value U[2][1];
+    eekf_value w[1];
+    eekf_acc acc;
+
+    // predict measurement and linearize measurement: zp = h(x), Jh = dh(x)/dx
+    if (NULL != ctx->h
+            && eEekfReturnOk != ctx->h(&zp, &Jh, ctx->x, ctx->userData))
+    {
+        return eEekfReturnCallbackFailed;
+    }
+
+    // cross covariance C = P * Jh'
+    C[0][0] = P_(0, 0);
+    C[1][0] = P_(1, 0);
+
+    // innovation covariance S = Jh * C + R
+    acc = EEKF_ACC(*EEKF_MAT_EL(*R, 0, 0));
+    acc = EEKF_MAC(acc, C[0][0], EEKF_VALUE(1));
+    S[0][0] = EEKF_ACC_VALUE(acc);
+
+    // cholesky factorization S = L * L'
+    L[0][0] = S[0][0];
+    if (L[0][0] <= 0)
+    {
+        return eEekfReturnComputationFailed;
+    }
+    L[0][0] = EEKF_VALUE_SQRT(L[0][0]);
+
+    // U = (L \ C')'
+    U[0][0] = C[0][0];
+    U[0][0] = EEKF_DIV(U[0][0], L[0][0]);
+    U[1][0] = C[1][0];
+    U[1][0] = EEKF_DIV(U[1][0], L[0][0]);
+
+    // w = L \ (z - zp)
+    w[0] = EEKF_SUB(*EEKF_MAT_EL(*z, 0, 0), *EEKF_MAT_EL(zp, 0, 0));
+    w[0] = EEKF_DIV(w[0], L[0][0]);
+
+    // correct state x = x + U * w
+    acc = EEKF_ACC(X_(0));
+    acc = EEKF_MAC(acc, U[0][0], w[0]);
+    X_(0) = EEKF_ACC_VALUE(acc);
+    acc = EEKF_ACC(X_(1));
+    acc = EEKF_MAC(acc, U[1][0], w[0]);
+    X_(1) = EEKF_ACC_VALUE(acc);
+
+    // correct covariance P = P - U * U'
+    acc = EEKF_ACC(P_(0, 0));
+    acc = EEKF_MSC(acc, U[0][0], U[0][0]);
+    P_(0, 0) = EEKF_ACC_VALUE(acc);
+    acc = EEKF_ACC(P_(0, 1));
+    acc = EEKF_MSC(acc, U[0][0], U[1][0]);
+    P_(0, 1) = EEKF_ACC_VALUE(acc);
+    P_(1, 0) = P_(0, 1);
+    acc = EEKF_ACC(P_(1, 1));
+    acc = EEKF_MSC(acc, U[1][0], U[1][0]);
+    P_(1, 1) = EEKF_ACC_VALUE(acc);
+
+    (void) acc;
+    eekf_publish_step(ctx->publish, ctx->x, ctx->P);
+    return eEekfReturnOk;
+}
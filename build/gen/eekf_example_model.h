@@ -0,0 +1,29 @@
+/* generated by eekf_gen, do not edit */
+
+#ifndef EEKF_EXAMPLE_MODEL_H
+#define EEKF_EXAMPLE_MODEL_H
+
+#include <eekf/eekf.h>
+
+/// number of states of the model
+#define EEKF_EXAMPLE_MODEL_N 2
+/// number of measurements of the model
+#define EEKF_EXAMPLE_MODEL_M 1
+
+/**
+ * Predict the next filter state, specialized eekf_predict().
+ *
+ * ctx->f must fill all non structural entries of Jf.
+ */
+eekf_return eekf_example_model_predict(eekf_context *ctx, eekf_mat const *u,
+        eekf_mat const *Q);
+
+/**
+ * Correct the current filter state, specialized eekf_correct().
+ *
+ * ctx->h must fill all non structural entries of Jh.
+ */
+eekf_return eekf_example_model_correct(eekf_context *ctx, eekf_mat const *z,
+        eekf_mat const *R);
+
+#endif /* EEKF_EXAMPLE_MODEL_H */
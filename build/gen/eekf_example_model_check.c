@@ -0,0 +1,154 @@
+/* generated by eekf_gen, do not edit */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "eekf_example_model.h"
+
+#define N 2
+#define M 1
+
+// structural patterns
+static char const F[N][N + 1] = { "1x", "01", };
+static char const H[M][N + 1] = { "10", };
+static char const Qp[N][N + 1] = { "xx", "xx", };
+static char const Rp[M][M + 1] = { "x", };
+
+// random values of the non structural entries
+static eekf_value Fv[N][N], Hv[M][N];
+
+static eekf_value pattern_value(char p, eekf_value v)
+{
+    return '0' == p ? 0 : '1' == p ? 1 : v;
+}
+
+// linear model xp = Jf * x with the structural pattern of Jf
+static eekf_return f(eekf_mat *xp, eekf_mat *Jf, eekf_mat const *x,
+        eekf_mat const *u, void *userData)
+{
+    int r, c;
+    for (r = 0; r < N; r++)
+    {
+        for (c = 0; c < N; c++)
+        {
+            *EEKF_MAT_EL(*Jf, r, c) = pattern_value(F[r][c], Fv[r][c]);
+        }
+    }
+    return NULL == eekf_mat_mul(xp, Jf, x) ? eEekfReturnComputationFailed
+            : eEekfReturnOk;
+}
+
+// linear measurement zp = Jh * x with the structural pattern of Jh
+static eekf_return h(eekf_mat *zp, eekf_mat *Jh, eekf_mat const *x,
+        void *userData)
+{
+    int r, c;
+    for (r = 0; r < M; r++)
+    {
+        for (c = 0; c < N; c++)
+        {
+            *EEKF_MAT_EL(*Jh, r, c) = pattern_value(H[r][c], Hv[r][c]);
+        }
+    }
+    return NULL == eekf_mat_mul(zp, Jh, x) ? eEekfReturnComputationFailed
+            : eEekfReturnOk;
+}
+
+// random symmetric positive definite matrix with given pattern
+static void random_cov(eekf_mat *A, char const *p, int stride)
+{
+    int r, c;
+    for (r = 0; r < A->rows; r++)
+    {
+        for (c = r; c < A->cols; c++)
+        {
+            eekf_value v = 'x' != p[r * stride + c] ? 0
+                    : r == c ? 1 + (eekf_value) rand() / RAND_MAX
+                    : 0.1 * ((eekf_value) rand() / RAND_MAX - 0.5) / A->rows;
+            *EEKF_MAT_EL(*A, r, c) = v;
+            *EEKF_MAT_EL(*A, c, r) = v;
+        }
+    }
+}
+
+static eekf_value max_diff(eekf_mat const *A, eekf_mat const *B)
+{
+    eekf_value d = 0;
+    int r, c;
+    for (r = 0; r < A->rows; r++)
+    {
+        for (c = 0; c < A->cols; c++)
+        {
+            eekf_value a = *EEKF_MAT_EL(*A, r, c), b = *EEKF_MAT_EL(*B, r, c);
+            d = fmax(d, fabs(a - b) / fmax(1, fabs(a)));
+        }
+    }
+    return d;
+}
+
+int main(int argc, char **argv)
+{
+    eekf_context generic, generated;
+    EEKF_DECL_MAT(x1, N, 1);
+    EEKF_DECL_MAT(P1, N, N);
+    EEKF_DECL_MAT(x2, N, 1);
+    EEKF_DECL_MAT(P2, N, N);
+    EEKF_DECL_MAT(Q, N, N);
+    EEKF_DECL_MAT(R, M, M);
+    EEKF_DECL_MAT(z, M, 1);
+    EEKF_DECL_MAT(u, 1, 1);
+    eekf_value d = 0;
+    int r, c, k;
+
+    srand(0);
+    for (r = 0; r < N; r++)
+    {
+        for (c = 0; c < N; c++)
+        {
+            Fv[r][c] = (eekf_value) rand() / RAND_MAX - 0.5;
+        }
+        *EEKF_MAT_EL(x1, r, 0) = eekf_randn();
+        *EEKF_MAT_EL(P1, r, r) = 1;
+    }
+    for (r = 0; r < M; r++)
+    {
+        for (c = 0; c < N; c++)
+        {
+            Hv[r][c] = (eekf_value) rand() / RAND_MAX - 0.5;
+        }
+    }
+    random_cov(&Q, Qp[0], N + 1);
+    random_cov(&R, Rp[0], M + 1);
+    memcpy(x2_elements, x1_elements, sizeof(x1_elements));
+    memcpy(P2_elements, P1_elements, sizeof(P1_elements));
+
+    eekf_init(&generic, &x1, &P1, f, h, NULL);
+    eekf_init(&generated, &x2, &P2, f, h, NULL);
+
+    for (k = 0; k < 100; k++)
+    {
+        for (r = 0; r < M; r++)
+        {
+            *EEKF_MAT_EL(z, r, 0) = eekf_randn();
+        }
+        if (eEekfReturnOk != eekf_predict(&generic, &u, &Q)
+                || eEekfReturnOk != eekf_correct(&generic, &z, &R))
+        {
+            printf("generic filter failed at step %d\n", k);
+            return 1;
+        }
+        if (eEekfReturnOk != eekf_example_model_predict(&generated, &u, &Q)
+                || eEekfReturnOk != eekf_example_model_correct(&generated, &z, &R))
+        {
+            printf("generated filter failed at step %d\n", k);
+            return 1;
+        }
+        d = fmax(d, fmax(max_diff(&x1, &x2), max_diff(&P1, &P2)));
+    }
+
+    printf("maximum relative deviation %g: %s\n", d,
+            d < 1e-9 ? "passed" : "FAILED");
+    return d < 1e-9 ? 0 : 1;
+}
@@ -42,6 +42,7 @@ typedef enum
 	eEekfReturnCallbackFailed,		//!< a callback function failed
 	eEekfReturnComputationFailed,	//!< a computation failed
 	eEekfReturnParameterError,		//!< function parameters are invalid
+	eEekfReturnQueueFull,			//!< a measurement queue or a pool is full
 } eekf_return;
 
 /**
@@ -77,6 +78,22 @@ typedef eekf_return (*ekkf_fun_f)(eekf_mat* xp, eekf_mat* Jf, eekf_mat const *x,
  */
 typedef eekf_return (*ekkf_fun_h)(eekf_mat* zp, eekf_mat* Jh, eekf_mat const *x, void* userData);
 
+/// innovation statistics of a correction step, in the wide format (see EEKF_WIDE_TO_REAL())
+typedef struct
+{
+	eekf_wide nis;		//!< normalized innovation squared (z - zp)' * S^-1 * (z - zp)
+	eekf_wide logDetS;	//!< natural logarithm of the innovation covariance determinant det(S)
+} eekf_innovation;
+
+/// state of a random number generator stream
+typedef struct
+{
+	uint64_t state;	//!< internal generator state
+} eekf_rng;
+
+/// published estimate for concurrent readers (see eekf_publish.h)
+struct eekf_publish;
+
 /// the filter context
 typedef struct
 {
@@ -85,6 +102,7 @@ typedef struct
 	ekkf_fun_f f;	//!< state transition function
 	ekkf_fun_h h;	//!< measurement prediction function
 	void *userData; //!< pointer to user defined data
+	struct eekf_publish *publish;	//!< optional published estimate updated by every step
 } eekf_context;
 
 /**
@@ -140,6 +158,110 @@ eekf_return eekf_predict(eekf_context *ctx, eekf_mat const *u,
 eekf_return eekf_correct(eekf_context *ctx, eekf_mat const *z,
 		eekf_mat const *R);
 
+/**
+ * Correct the current filter state and report the innovation statistics.
+ *
+ * This function behaves like eekf_correct(). Additionally it reports the normalized innovation
+ * squared and the log-determinant of the innovation covariance S, which are taken from the
+ * Cholesky factorization of S the correction computes anyway. Both are required for consistency
+ * tests (NIS) and measurement likelihoods.
+ *
+ * @param [in/out] ctx	pointer to the filter context
+ * @param [in]	   z	pointer to the matrix holding the measurement values
+ * @param [in]	   R	pointer to the matrix holding the measurement covariance
+ * @param [out]	   inno	pointer to the innovation statistics (may be NULL)
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_correct_innovation(eekf_context *ctx, eekf_mat const *z,
+		eekf_mat const *R, eekf_innovation *inno);
+
+/**
+ * Linearize the measurement and factorize the innovation covariance at the current state.
+ *
+ * The first half of eekf_correct_innovation(), it does not change the filter state. Together with
+ * eekf_correct_factored() it allows to check several filters before correcting any of them.
+ *
+ * @param [in]  ctx		pointer to the filter context
+ * @param [in]  z		pointer to the matrix holding the measurement values
+ * @param [in]  R		pointer to the matrix holding the measurement covariance
+ * @param [out] zp		pointer to the matrix that will hold the predicted measurement h(x)
+ * @param [out] PJht	pointer to the matrix that will hold the cross covariance P * Jh'
+ * @param [out] L		pointer to the matrix that will hold the Cholesky factor of S = L * L'
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_correct_factor(eekf_context const *ctx, eekf_mat const *z,
+		eekf_mat const *R, eekf_mat *zp, eekf_mat *PJht, eekf_mat *L);
+
+/**
+ * Correct the current filter state with a factorized innovation covariance.
+ *
+ * The correction step of eekf_correct_innovation() for callers which already linearized the
+ * measurement at the current state, e.g. to gate measurements before choosing one. The estimate
+ * is published like in every other step.
+ *
+ * @param [in/out] ctx	pointer to the filter context
+ * @param [in]	   z	pointer to the matrix holding the measurement values
+ * @param [in]	   zp	pointer to the matrix holding the predicted measurement h(x)
+ * @param [in]	   PJht	pointer to the cross covariance P * Jh'
+ * @param [in]	   L	pointer to the Cholesky factor of S = Jh * P * Jh' + R = L * L'
+ * @param [out]	   inno	pointer to the innovation statistics (may be NULL)
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_correct_factored(eekf_context *ctx, eekf_mat const *z,
+		eekf_mat const *zp, eekf_mat const *PJht, eekf_mat const *L,
+		eekf_innovation *inno);
+
+/**
+ * Compute the innovation statistics from the factorized innovation covariance.
+ *
+ * Shared by all filter variants reporting innovation statistics.
+ *
+ * @param [out] inno	pointer to the innovation statistics (may be NULL)
+ * @param [in]	L		pointer to the Cholesky factor of the innovation covariance S = L * L'
+ * @param [in]	Ldz		pointer to the whitened innovation L \ (z - zp)
+ * @return returns the pointer to the innovation statistics on success, NULL otherwise
+ */
+eekf_innovation* eekf_innovation_compute(eekf_innovation *inno,
+		eekf_mat const *L, eekf_mat const *Ldz);
+
+/**
+ * Predict the next filter state while leaving frozen states untouched.
+ *
+ * Like eekf_predict() but only the k given active states are predicted. The remaining states are
+ * frozen: their values and their block of P are kept as they are. This is exact if the frozen
+ * states are constant, i.e. their rows of Jf are the unit rows and their process noise is zero.
+ * Active states may depend on frozen ones (e.g. sensor biases). Only the active rows of Jf and the
+ * active block of Q are used. The cost of the covariance prediction is O(k*N^2) instead of O(N^3).
+ *
+ * @param [in/out] ctx		pointer to the filter context
+ * @param [in] 	   u		pointer to the matrix holding input values
+ * @param [in]	   Q		pointer to the matrix holding the process covariance
+ * @param [in]	   active	pointer to the indices of the active states (each listed once)
+ * @param [in]	   nActive	number of active states
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_predict_partial(eekf_context *ctx, eekf_mat const *u,
+		eekf_mat const *Q, uint8_t const *active, uint8_t nActive);
+
+/**
+ * Correct the current filter state treating all but the given states as consider states.
+ *
+ * This implements the Schmidt (consider-state) update: the consider states contribute their
+ * uncertainty to the innovation covariance, but neither they nor their block of P are corrected.
+ * Only the rows and columns of P belonging to the k active states are updated. Columns of Jh which
+ * are zero are skipped when forming P*Jh' and S. The cost of the covariance correction is
+ * O(k*N*M) instead of O(N^2*M).
+ *
+ * @param [in/out] ctx		pointer to the filter context
+ * @param [in]	   z		pointer to the matrix holding the measurement values
+ * @param [in]	   R		pointer to the matrix holding the measurement covariance
+ * @param [in]	   active	pointer to the indices of the active states (each listed once)
+ * @param [in]	   nActive	number of active states
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_correct_partial(eekf_context *ctx, eekf_mat const *z,
+		eekf_mat const *R, uint8_t const *active, uint8_t nActive);
+
 /**
  * Compute a random number of a normal distribution with standard deviation of 1.
  *
@@ -149,4 +271,25 @@ eekf_return eekf_correct(eekf_context *ctx, eekf_mat const *z,
  */
 eekf_value eekf_randn();
 
+/**
+ * Seed a random number generator stream.
+ *
+ * Streams seeded with the same seed but different stream numbers produce independent sequences.
+ * Unlike eekf_randn() the generator holds no global state and can be used from multiple threads,
+ * one stream per thread.
+ *
+ * @param [out] rng		pointer to the generator to seed
+ * @param [in]	seed	common seed value
+ * @param [in]	stream	number of the stream
+ */
+void eekf_rng_seed(eekf_rng *rng, uint64_t seed, uint64_t stream);
+
+/**
+ * Compute a random number of a normal distribution with standard deviation of 1 from a given stream.
+ *
+ * @param [in/out] rng	pointer to the generator stream
+ * @return returns the random number
+ */
+eekf_value eekf_randn_r(eekf_rng *rng);
+
 #endif /* EEKF_H */
@@ -0,0 +1,206 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+
+/**
+ * Sensor fusion runtime driving a filter context from timestamped measurement queues.
+ *
+ * Every sensor owns a bounded lock-free multi-producer single-consumer queue of timestamped
+ * measurements together with its measurement function h and covariance R. Any number of threads
+ * may push measurements, a push never blocks: if the queue is full the measurement is dropped and
+ * counted. A single consumer thread merges all queues in time order, predicts the filter up to
+ * each measurement time and corrects it with the measurement.
+ *
+ * No memory is allocated, the user provides the queue storage.
+ *
+ * @copyright	The MIT Licence
+ * @file		eekf_fusion.h
+ * @author 		Christian Meißner
+ */
+
+#ifndef EEKF_FUSION_H
+#define EEKF_FUSION_H
+
+#include <eekf/eekf.h>
+
+/// size of a cache line, queue positions and counters written by different threads are kept apart by it
+#define EEKF_FUSION_CACHE_LINE 64
+
+/// declare the storage of a sensor queue holding capacity measurements of given dimension
+#define EEKF_FUSION_DECL_QUEUE(name, capacity, dim)\
+	eekf_fusion_slot name##_slots[(capacity)];\
+	eekf_value name##_values[(capacity)*(dim)];
+
+/**
+ * Function type to prepare the prediction over a time step.
+ *
+ * The function computes the input u and the process noise covariance Q for the prediction from
+ * the current filter time by dt. It may also store dt where the state transition function f
+ * picks it up (e.g. in the user data of the filter context).
+ *
+ * @param [out] u			pointer to the matrix that will hold the input variables
+ * @param [out] Q			pointer to the matrix that will hold the process noise covariance
+ * @param [in]	dt			time step of the prediction
+ * @param [in]	userData	pointer to the optional user data
+ * @return should return eEekfReturnOk if computation succeeded
+ */
+typedef eekf_return (*eekf_fusion_fun_prepare)(eekf_mat *u, eekf_mat *Q,
+		eekf_value dt, void *userData);
+
+/// slot of a measurement queue
+typedef struct
+{
+	uint32_t seq;		//!< sequence number of the slot (queue internal)
+	eekf_value t;		//!< time stamp of the measurement
+	eekf_value *z;		//!< pointer to the measurement values
+} eekf_fusion_slot;
+
+/// sensor statistics
+typedef struct
+{
+	uint32_t pushed;	//!< number of measurements queued
+	uint32_t dropped;	//!< number of measurements dropped because the queue was full
+	uint32_t late;		//!< number of measurements dropped because they were older than the filter
+	uint32_t processed;	//!< number of measurements the filter was corrected with
+	uint32_t failed;	//!< number of measurements with a failed correction
+	uint32_t maxFill;	//!< maximum number of queued measurements seen by the consumer
+} eekf_fusion_stats;
+
+/// sensor with its measurement queue
+typedef struct
+{
+	uint32_t head __attribute__((aligned(EEKF_FUSION_CACHE_LINE)));	//!< next write position
+	uint32_t pushed __attribute__((aligned(EEKF_FUSION_CACHE_LINE)));	//!< producer counter: measurements queued
+	uint32_t dropped;			//!< producer counter: measurements dropped because the queue was full
+	uint32_t tail __attribute__((aligned(EEKF_FUSION_CACHE_LINE)));	//!< next read position
+	eekf_fusion_slot *slots;	//!< queue slots
+	uint32_t mask;				//!< capacity - 1
+	uint8_t dim;				//!< dimension of the measurements
+	ekkf_fun_h h;				//!< measurement prediction function
+	eekf_mat const *R;			//!< measurement noise covariance
+	void *userData;				//!< pointer to user defined data passed to h
+	uint32_t late;				//!< consumer counter: measurements older than the filter
+	uint32_t processed;			//!< consumer counter: measurements the filter was corrected with
+	uint32_t failed;			//!< consumer counter: measurements with a failed correction
+	uint32_t maxFill;			//!< consumer counter: maximum number of queued measurements seen
+} eekf_fusion_sensor;
+
+/// the fusion runtime
+typedef struct
+{
+	eekf_context *ctx;					//!< filter context
+	eekf_fusion_sensor *sensors;		//!< sensors
+	uint8_t nSensors;					//!< number of sensors
+	eekf_fusion_fun_prepare prepare;	//!< prediction preparation function
+	eekf_mat *u;						//!< input variables of the prediction
+	eekf_mat *Q;						//!< process noise covariance of the prediction
+	void *userData;						//!< pointer to user defined data passed to prepare
+	eekf_value t;						//!< current time of the filter state
+} eekf_fusion;
+
+/**
+ * Initialize a sensor and its measurement queue.
+ *
+ * @param [out] sensor		pointer to the sensor to initialize
+ * @param [in]	slots		pointer to capacity queue slots
+ * @param [in]	values		pointer to capacity * dim values holding the queued measurements
+ * @param [in]	capacity	queue capacity, must be a power of two
+ * @param [in]	dim			dimension of the measurements
+ * @param [in]	h			function pointer to the measurement prediction function
+ * @param [in]	R			pointer to the matrix holding the measurement covariance (dim x dim)
+ * @param [in]	userData	optional pointer to user data passed to h
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_fusion_sensor_init(eekf_fusion_sensor *sensor,
+		eekf_fusion_slot *slots, eekf_value *values, uint32_t capacity,
+		uint8_t dim, ekkf_fun_h h, eekf_mat const *R, void *userData);
+
+/**
+ * Queue a measurement of a sensor.
+ *
+ * May be called from any thread concurrently. The function never blocks. If the queue is full the
+ * measurement is dropped.
+ *
+ * @param [in/out] sensor	pointer to the sensor
+ * @param [in]	   t		time stamp of the measurement
+ * @param [in]	   z		pointer to the dim measurement values
+ * @return returns eEekfReturnOk on success, eEekfReturnQueueFull if the measurement was dropped
+ */
+eekf_return eekf_fusion_push(eekf_fusion_sensor *sensor, eekf_value t,
+		eekf_value const *z);
+
+/**
+ * Get the number of measurements currently queued for a sensor.
+ *
+ * @param [in] sensor	pointer to the sensor
+ * @return returns the number of queued measurements
+ */
+uint32_t eekf_fusion_fill(eekf_fusion_sensor const *sensor);
+
+/**
+ * Get a copy of the sensor statistics.
+ *
+ * May be called from any thread. The counters are read individually and are not a consistent
+ * snapshot among each other.
+ *
+ * @param [out] stats	pointer to the statistics to fill
+ * @param [in]	sensor	pointer to the sensor
+ */
+void eekf_fusion_get_stats(eekf_fusion_stats *stats,
+		eekf_fusion_sensor const *sensor);
+
+/**
+ * Initialize the fusion runtime.
+ *
+ * @param [out] fusion		pointer to the fusion runtime to initialize
+ * @param [in]	ctx			pointer to the initialized filter context
+ * @param [in]	t0			time of the initial filter state
+ * @param [in]	sensors		pointer to the initialized sensors
+ * @param [in]	nSensors	number of sensors
+ * @param [in]	prepare		function pointer to the prediction preparation function
+ * @param [in]	u			pointer to the matrix to hold the prediction input variables
+ * @param [in]	Q			pointer to the matrix to hold the process noise covariance
+ * @param [in]	userData	optional pointer to user data passed to prepare
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_fusion_init(eekf_fusion *fusion, eekf_context *ctx,
+		eekf_value t0, eekf_fusion_sensor *sensors, uint8_t nSensors,
+		eekf_fusion_fun_prepare prepare, eekf_mat *u, eekf_mat *Q,
+		void *userData);
+
+/**
+ * Process queued measurements in time order.
+ *
+ * Processes all queued measurements with a time stamp up to the given time, oldest first. For
+ * each measurement the filter is predicted to the measurement time and corrected with the
+ * measurement function, covariance and user data of its sensor. Measurements older than the
+ * current filter time are dropped and counted as late. Must only be called from a single thread,
+ * the thread owning the filter context.
+ *
+ * @param [in/out] fusion	pointer to the fusion runtime
+ * @param [in]	   until	time up to which measurements are processed
+ * @return returns eEekfReturnOk on success, the error of a failed prediction otherwise
+ */
+eekf_return eekf_fusion_run(eekf_fusion *fusion, eekf_value until);
+
+#endif /* EEKF_FUSION_H */
@@ -0,0 +1,172 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+/**
+ * Interacting Multiple Model (IMM) filter built on model matched extended Kalman filters.
+ *
+ * The IMM runs r filters with different state transition functions and process noise on a common
+ * state vector. Before each prediction the model estimates are mixed according to the Markov model
+ * transition probabilities, after each correction the model probabilities are updated with the
+ * measurement likelihoods of the models and the estimates are combined into a single estimate.
+ *
+ * The model estimates are kept twice in the user provided storage. Predict mixes into the second
+ * copy, the models are predicted there and the buffers are swapped only once all models
+ * succeeded. Correct factorizes the innovation covariances of all models with
+ * eekf_correct_factor() first and only then corrects the models in place with
+ * eekf_correct_factored(), so no estimate is copied. A failing step thus leaves the IMM unchanged.
+ * Mixing and combination accumulate the weighted means and spread of means of all models in a
+ * single pass over the upper triangle of the covariances. The likelihoods are taken from the
+ * innovation statistics of the factorized innovation covariances and normalized in the log domain.
+ *
+ * @copyright	The MIT Licence
+ * @file		eekf_imm.h
+ * @author 		Christian Meißner
+ */
+
+#ifndef EEKF_IMM_H
+#define EEKF_IMM_H
+
+#include <eekf/eekf.h>
+
+/// maximum number of models
+#define EEKF_IMM_MAX_MODELS 8
+
+/// number of values of the storage of an IMM with the given number of models and states
+#define EEKF_IMM_STORAGE_SIZE(models, states)\
+	((2 * (models) + 1) * ((states) + (states) * (states)))
+
+/// declare the storage of an IMM with the given number of models and states
+#define EEKF_IMM_DECL_STORAGE(name, models, states)\
+	eekf_value name##_values[EEKF_IMM_STORAGE_SIZE(models, states)];
+
+/**
+ * Function type to prepare a measurement once for all models.
+ *
+ * The function is called once per correction on copies of the measurement and its covariance
+ * before they are passed to the model filters, e.g. to debias or convert a measurement.
+ *
+ * @param [in/out] z		pointer to the matrix holding the measurement values
+ * @param [in/out] R		pointer to the matrix holding the measurement covariance
+ * @param [in]	   userData	pointer to the optional user data
+ * @return should return eEekfReturnOk if computation succeeded
+ */
+typedef eekf_return (*eekf_imm_fun_prepare)(eekf_mat *z, eekf_mat *R,
+		void *userData);
+
+/// the IMM context
+typedef struct
+{
+	eekf_context models[EEKF_IMM_MAX_MODELS];	//!< model matched filters
+	eekf_mat xs[2][EEKF_IMM_MAX_MODELS];		//!< double buffered model states
+	eekf_mat Ps[2][EEKF_IMM_MAX_MODELS];		//!< double buffered model covariances
+	eekf_mat x;									//!< combined state
+	eekf_mat P;									//!< combined covariance
+	eekf_value mu[EEKF_IMM_MAX_MODELS];			//!< model probabilities
+	eekf_value logLikelihood;					//!< log-likelihood of the last measurement
+	eekf_mat const *Pi;							//!< model transition probabilities (r x r)
+	eekf_imm_fun_prepare prepare;				//!< optional measurement preparation
+	void *userData;								//!< pointer to user defined data passed to prepare
+	struct eekf_publish *publish;				//!< optional published combined estimate
+	uint8_t nModels;							//!< number of models r
+	uint8_t buffer;								//!< buffer holding the current model estimates
+} eekf_imm;
+
+/**
+ * Initialize an IMM.
+ *
+ * All models start with the given estimate and equal probabilities. The models share the
+ * measurement prediction function h and the user data, the latter can be changed per model
+ * through the model contexts afterwards.
+ *
+ * Pi(i, j) is the probability of a transition from model i to model j between two predictions,
+ * i.e. the rows of Pi sum up to 1.
+ *
+ * @param [out] imm			pointer to the IMM to initialize
+ * @param [in]	values		pointer to EEKF_IMM_STORAGE_SIZE(nModels, N) values holding the estimates
+ * @param [in]	nModels		number of models r
+ * @param [in]	x0			pointer to the matrix holding the initial state (N x 1)
+ * @param [in]	P0			pointer to the matrix holding the initial covariance (N x N)
+ * @param [in]	f			pointer to r state transition functions
+ * @param [in]	h			function pointer to the measurement prediction function
+ * @param [in]	Pi			pointer to the matrix holding the model transition probabilities
+ * @param [in]	userData	optional pointer to user data passed to f and h
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_imm_init(eekf_imm *imm, eekf_value *values, uint8_t nModels,
+		eekf_mat const *x0, eekf_mat const *P0, ekkf_fun_f const *f,
+		ekkf_fun_h h, eekf_mat const *Pi, void *userData);
+
+/**
+ * Set the measurement preparation function.
+ *
+ * @param [in/out] imm		pointer to the IMM
+ * @param [in]	   prepare	function pointer to the preparation function (may be NULL)
+ * @param [in]	   userData	optional pointer to user data passed to prepare
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_imm_set_prepare(eekf_imm *imm, eekf_imm_fun_prepare prepare,
+		void *userData);
+
+/**
+ * Attach a published estimate to an IMM filter.
+ *
+ * Behaves like eekf_publish_attach() (see eekf_publish.h), the combined estimate of the IMM is
+ * published.
+ *
+ * @param [in/out] imm	pointer to the IMM
+ * @param [in/out] pub	pointer to the published estimate (may be NULL)
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_publish_attach_imm(eekf_imm *imm, struct eekf_publish *pub);
+
+/**
+ * Predict the next IMM state.
+ *
+ * Mixes the model estimates, predicts every model with its process noise covariance and combines
+ * the predicted estimates. The model probabilities are replaced by the predicted ones. If a model
+ * fails the IMM is left unchanged.
+ *
+ * @param [in/out] imm	pointer to the IMM
+ * @param [in]	   u	pointer to the matrix holding input values
+ * @param [in]	   Q	pointer to r matrices holding the process covariances of the models
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_imm_predict(eekf_imm *imm, eekf_mat const *u,
+		eekf_mat const * const *Q);
+
+/**
+ * Correct the current IMM state.
+ *
+ * Prepares the measurement once, corrects every model with it, updates the model probabilities
+ * with the measurement likelihoods and combines the corrected estimates. If a model fails the IMM
+ * is left unchanged.
+ *
+ * @param [in/out] imm	pointer to the IMM
+ * @param [in]	   z	pointer to the matrix holding the measurement values
+ * @param [in]	   R	pointer to the matrix holding the measurement covariance
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_imm_correct(eekf_imm *imm, eekf_mat const *z,
+		eekf_mat const *R);
+
+#endif /* EEKF_IMM_H */
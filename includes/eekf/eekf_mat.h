@@ -40,45 +40,380 @@
 #define EEKF_MAT_RAND rand
 #define EEKF_MAT_RAND_MAX RAND_MAX
 
+#ifdef EEKF_FIXED
+
+/*
+ * Fixed-point build.
+ *
+ * Defining EEKF_FIXED turns eekf_value into a 32 bit signed fixed-point number with
+ * EEKF_FIXED_FRAC fractional bits, e.g. 16 for Q16.16 (the default) or 30 for Q2.30. Sums and
+ * products saturate instead of wrapping around, dot products are accumulated in 64 bit and
+ * rounded once. No floating-point operation is involved in matrix computations, predict and
+ * correct, including the innovation statistics (NIS and log det(S) use an integer logarithm).
+ * The innovation statistics are held in the 64 bit eekf_wide format with the same fractional
+ * bits, log det(S) thus does not saturate for small innovation covariances, e.g. below e^-2 in
+ * Q2.30. The entries of the whitened innovation L \ (z - zp) still saturate at
+ * EEKF_VALUE_MAX_REAL, which limits the NIS to M * EEKF_VALUE_MAX_REAL^2 (about 4 * M in Q2.30).
+ * Only the conversions EEKF_VALUE()/EEKF_VALUE_TO_REAL() and the simulation helpers eekf_randn()
+ * and eekf_randn_r() still use double arithmetic.
+ *
+ * Scaling guidance: all matrices share one format, so choose the units of the states and
+ * measurements such that
+ * - every state, measurement and innovation magnitude stays below EEKF_VALUE_MAX_REAL,
+ * - every entry of P, Q, R and S = Jh*P*Jh' + R stays below EEKF_VALUE_MAX_REAL,
+ * - the variances of interest are at least some hundred EEKF_VALUE_EPS_REAL. Variances are
+ *   squares, standard deviations below sqrt(EEKF_VALUE_EPS_REAL) are not representable.
+ * For Q16.16 this means standard deviations between about 0.05 and 180 units, for Q2.30 about
+ * 0.001 to 1.4 units. eekf_mat_headroom() reports how many integer bits of a matrix are unused
+ * and can be used to check the scaling at run time.
+ */
+
+#include <limits.h>
+
+#ifndef EEKF_FIXED_FRAC
+#define EEKF_FIXED_FRAC 16
+#endif
+
+/// matrix value type
+typedef int32_t eekf_value;
+/// accumulator type of dot products
+typedef int64_t eekf_acc;
+/// wide value type of statistics exceeding the matrix value range, EEKF_FIXED_FRAC fractional bits
+typedef int64_t eekf_wide;
+
+/// fixed-point value of one
+#define EEKF_VALUE_ONE ((int64_t) 1 << EEKF_FIXED_FRAC)
+/// largest representable real value
+#define EEKF_VALUE_MAX_REAL ((double) INT32_MAX / EEKF_VALUE_ONE)
+/// resolution as real value
+#define EEKF_VALUE_EPS_REAL (1.0 / EEKF_VALUE_ONE)
+
+/// convert a real value to a matrix value (rounded, not saturated)
+#define EEKF_VALUE(v) eekf_value_from_real((v))
+/// convert a matrix value to a real value
+#define EEKF_VALUE_TO_REAL(v) ((double) (v) / EEKF_VALUE_ONE)
+/// convert a wide value to a real value
+#define EEKF_WIDE_TO_REAL(v) ((double) (v) / EEKF_VALUE_ONE)
+
+/// convert a real value to a matrix value, v is evaluated once
+static inline eekf_value eekf_value_from_real(double v)
+{
+	return (eekf_value) (v * EEKF_VALUE_ONE + (v < 0 ? -0.5 : 0.5));
+}
+
+/// saturate a 64 bit value to a matrix value
+static inline eekf_value eekf_fixed_sat(int64_t v)
+{
+	return v > INT32_MAX ? INT32_MAX : v < INT32_MIN ? INT32_MIN : (eekf_value) v;
+}
+
+/// saturating addition
+static inline eekf_value eekf_fixed_add(eekf_value a, eekf_value b)
+{
+	return eekf_fixed_sat((int64_t) a + b);
+}
+
+/// saturating subtraction
+static inline eekf_value eekf_fixed_sub(eekf_value a, eekf_value b)
+{
+	return eekf_fixed_sat((int64_t) a - b);
+}
+
+/// convert an accumulator to a matrix value with rounding and saturation
+static inline eekf_value eekf_fixed_acc_value(eekf_acc acc)
+{
+	if (acc > INT64_MAX - (EEKF_VALUE_ONE >> 1))
+	{
+		return INT32_MAX;
+	}
+	return eekf_fixed_sat((acc + (EEKF_VALUE_ONE >> 1)) >> EEKF_FIXED_FRAC);
+}
+
+/// saturating multiply-accumulate acc + a * b
+static inline eekf_acc eekf_fixed_mac(eekf_acc acc, eekf_value a, eekf_value b)
+{
+	int64_t p = (int64_t) a * b;
+	int64_t r;
+	if (__builtin_add_overflow(acc, p, &r))
+	{
+		r = p > 0 ? INT64_MAX : INT64_MIN;
+	}
+	return r;
+}
+
+/// saturating multiply-subtract acc - a * b
+static inline eekf_acc eekf_fixed_msc(eekf_acc acc, eekf_value a, eekf_value b)
+{
+	int64_t p = (int64_t) a * b;
+	int64_t r;
+	if (__builtin_sub_overflow(acc, p, &r))
+	{
+		r = p < 0 ? INT64_MAX : INT64_MIN;
+	}
+	return r;
+}
+
+/// saturating multiplication with rounding
+static inline eekf_value eekf_fixed_mul(eekf_value a, eekf_value b)
+{
+	return eekf_fixed_acc_value((int64_t) a * b);
+}
+
+/// saturating division with rounding, division by zero saturates
+static inline eekf_value eekf_fixed_div(eekf_value a, eekf_value b)
+{
+	if (0 == b)
+	{
+		return a < 0 ? INT32_MIN : INT32_MAX;
+	}
+	int64_t n = (int64_t) a * EEKF_VALUE_ONE;
+	int64_t q = n / b;
+	int64_t r = n % b;
+	if (2 * (r < 0 ? -r : r) >= (b < 0 ? -(int64_t) b : b))
+	{
+		q += (n < 0) != (b < 0) ? -1 : 1;
+	}
+	return eekf_fixed_sat(q);
+}
+
+/// integer square root with rounding, negative values yield zero
+static inline eekf_value eekf_fixed_sqrt(eekf_value a)
+{
+	if (a <= 0)
+	{
+		return 0;
+	}
+	uint64_t n = (uint64_t) a << EEKF_FIXED_FRAC;
+	uint64_t r = 0;
+	uint64_t bit = (uint64_t) 1 << 62;
+	while (bit > n)
+	{
+		bit >>= 2;
+	}
+	while (0 != bit)
+	{
+		if (n >= r + bit)
+		{
+			n -= r + bit;
+			r = (r >> 1) + bit;
+		}
+		else
+		{
+			r >>= 1;
+		}
+		bit >>= 2;
+	}
+	// round to nearest, n holds the remainder
+	if (n > r)
+	{
+		r++;
+	}
+	return eekf_fixed_sat((int64_t) r);
+}
+
+/// ln(2) with 28 fractional bits
+#define EEKF_FIXED_LN2 ((int64_t) 186065280)
+
+/// product in the wide format with rounding, never saturates
+static inline eekf_wide eekf_fixed_mul_wide(eekf_value a, eekf_value b)
+{
+	return ((int64_t) a * b + (EEKF_VALUE_ONE >> 1)) >> EEKF_FIXED_FRAC;
+}
+
+/// natural logarithm in the wide format, non-positive values yield the most negative matrix value
+static inline eekf_wide eekf_fixed_log_wide(eekf_value a)
+{
+	if (a <= 0)
+	{
+		return INT32_MIN;
+	}
+	// integer part of log2 from the leading bit, mantissa y in [1, 2)
+	int msb = 31 - __builtin_clz((uint32_t) a);
+	int64_t l2 = (int64_t) (msb - EEKF_FIXED_FRAC) * EEKF_VALUE_ONE;
+	uint64_t y = msb > EEKF_FIXED_FRAC ? (uint64_t) a >> (msb - EEKF_FIXED_FRAC)
+			: (uint64_t) a << (EEKF_FIXED_FRAC - msb);
+	int i;
+	// fractional bits of log2 by repeated squaring
+	for (i = 1; i <= EEKF_FIXED_FRAC; i++)
+	{
+		y = (y * y) >> EEKF_FIXED_FRAC;
+		if (y >= (uint64_t) 2 << EEKF_FIXED_FRAC)
+		{
+			y >>= 1;
+			l2 += EEKF_VALUE_ONE >> i;
+		}
+	}
+	// ln(a) = log2(a) * ln(2)
+	int64_t l = l2 * EEKF_FIXED_LN2;
+	int64_t half = (int64_t) 1 << 27;
+	return (l + (l < 0 ? -half : half)) / (half << 1);
+}
+
+/// natural logarithm, saturated to the matrix value range (e.g. -2 below e^-2 in Q2.30)
+static inline eekf_value eekf_fixed_log(eekf_value a)
+{
+	return eekf_fixed_sat(eekf_fixed_log_wide(a));
+}
+
+#define EEKF_ADD(a, b) eekf_fixed_add((a), (b))
+#define EEKF_SUB(a, b) eekf_fixed_sub((a), (b))
+#define EEKF_MUL(a, b) eekf_fixed_mul((a), (b))
+#define EEKF_DIV(a, b) eekf_fixed_div((a), (b))
+#define EEKF_VALUE_SQRT(a) eekf_fixed_sqrt((a))
+#define EEKF_VALUE_LOG(a) eekf_fixed_log((a))
+#define EEKF_VALUE_LOG_WIDE(a) eekf_fixed_log_wide((a))
+#define EEKF_MUL_WIDE(a, b) eekf_fixed_mul_wide((a), (b))
+#define EEKF_ACC(v) ((eekf_acc) (v) * EEKF_VALUE_ONE)
+#define EEKF_MAC(acc, a, b) eekf_fixed_mac((acc), (a), (b))
+#define EEKF_MSC(acc, a, b) eekf_fixed_msc((acc), (a), (b))
+#define EEKF_ACC_VALUE(acc) eekf_fixed_acc_value((acc))
+
+#else
+
 /// matrix value type
 typedef double eekf_value;
+/// accumulator type of dot products
+typedef double eekf_acc;
+/// wide value type of statistics exceeding the matrix value range
+typedef double eekf_wide;
+
+/// convert a real value to a matrix value
+#define EEKF_VALUE(v) ((eekf_value) (v))
+/// convert a matrix value to a real value
+#define EEKF_VALUE_TO_REAL(v) ((double) (v))
+/// convert a wide value to a real value
+#define EEKF_WIDE_TO_REAL(v) ((double) (v))
+
+#define EEKF_ADD(a, b) ((a) + (b))
+#define EEKF_SUB(a, b) ((a) - (b))
+#define EEKF_MUL(a, b) ((a) * (b))
+#define EEKF_DIV(a, b) ((a) / (b))
+#define EEKF_VALUE_SQRT(a) EEKF_MAT_SQRT(a)
+#define EEKF_VALUE_LOG(a) EEKF_MAT_LOG(a)
+#define EEKF_VALUE_LOG_WIDE(a) EEKF_MAT_LOG(a)
+#define EEKF_MUL_WIDE(a, b) ((eekf_wide) (a) * (b))
+#define EEKF_ACC(v) ((eekf_acc) (v))
+#define EEKF_MAC(acc, a, b) ((acc) + (a) * (b))
+#define EEKF_MSC(acc, a, b) ((acc) - (a) * (b))
+#define EEKF_ACC_VALUE(acc) ((eekf_value) (acc))
+
+#endif /* EEKF_FIXED */
 
 /// base matrix structure type
 typedef struct {
 	eekf_value *elements;	//!< pointer to matrix elements (column major order)
 	uint8_t rows;			//!< number of rows
 	uint8_t cols;			//!< number of columns
+	uint16_t ld;			//!< leading dimension (elements between column starts), 0 for packed
 } eekf_mat;
 
-/// assign data to a matrix
+/// alignment in bytes of the columns of matrices declared by EEKF_DECL_MAT_ALIGNED
+#define EEKF_MAT_ALIGN 64
+
+/// number of rows a column is padded to such that every column starts on an aligned boundary
+#define EEKF_MAT_PAD(rows)\
+	((((rows) * sizeof(eekf_value) + EEKF_MAT_ALIGN - 1) / EEKF_MAT_ALIGN)\
+			* (EEKF_MAT_ALIGN / sizeof(eekf_value)))
+
+/// get the leading dimension of a matrix, packed matrices (ld of 0) have a leading dimension of rows
+#define EEKF_MAT_LD(mat) ((mat).ld ? (mat).ld : (uint16_t) (mat).rows)
+
+/// assign data to a packed matrix
 #define EEKF_ASSIGN_MATRIX(matrix, data, rows, cols)\
 	do {\
 		(matrix).elements = data;\
 		(matrix).rows = rows;\
 		(matrix).cols = cols;\
+		(matrix).ld = 0;\
 	} while(0)
 
 /// declare a matrix with a non constant size (e.g. function parameter dependent)
 #define EEKF_DECL_MAT_DYN(name, rows, cols)\
 	eekf_value name##_elements[(rows)*(cols)];\
-	eekf_mat name = {name##_elements, (rows), (cols)};
+	eekf_mat name = {name##_elements, (rows), (cols), 0};
 
 /// declare a matrix with given size and value initialization
 #define EEKF_DECL_MAT_INIT(name, rows, cols, ...)\
 	eekf_value name##_elements[(rows)*(cols)] = {__VA_ARGS__};\
-	eekf_mat name = {name##_elements, (rows), (cols)};
+	eekf_mat name = {name##_elements, (rows), (cols), 0};
 
 /// declare a matrix with given size and initialize elements to zero
 #define EEKF_DECL_MAT(name, rows, cols) EEKF_DECL_MAT_INIT(name, rows, cols, 0)
 
+/// declare a matrix whose columns start on EEKF_MAT_ALIGN byte boundaries (elements are not initialized)
+#define EEKF_DECL_MAT_ALIGNED(name, rows, cols)\
+	eekf_value name##_elements[EEKF_MAT_PAD(rows)*(cols)]\
+			__attribute__((aligned(EEKF_MAT_ALIGN)));\
+	eekf_mat name = {name##_elements, (rows), (cols), EEKF_MAT_PAD(rows)};
+
 /// get pointer to a given row of a matrix
 #define EEKF_MAT_ROW(mat, i) ((mat).elements + (i))
 
 /// get pointer to a given col of a matrix
-#define EEKF_MAT_COL(mat, j) ((mat).elements + (mat).rows * (j))
+#define EEKF_MAT_COL(mat, j) ((mat).elements + EEKF_MAT_LD(mat) * (j))
 
 /// get pointer to a given element of a matrix
-#define EEKF_MAT_EL(mat, r, c) ((mat).elements + (c) * (mat).rows + (r))
+#define EEKF_MAT_EL(mat, r, c) ((mat).elements + (c) * EEKF_MAT_LD(mat) + (r))
+
+/**
+ * Creates a view on a block of a matrix.
+ *
+ * The view shares the elements of A, writing to the view writes to A. Views can be passed to
+ * all matrix functions, but they cannot be reshaped, i.e. a view used as result has to match
+ * the result dimensions exactly unless its columns are contiguous.
+ *
+ * @param [out] V    pointer to matrix to hold the view
+ * @param [in]  A    pointer to the viewed matrix
+ * @param [in]  r    first row of the block
+ * @param [in]  c    first column of the block
+ * @param [in]  rows number of rows of the block
+ * @param [in]  cols number of columns of the block
+ * @return returns the pointer to the view on success, NULL otherwise
+ */
+eekf_mat* eekf_mat_block(eekf_mat *V, eekf_mat const *A, uint8_t r, uint8_t c,
+		uint8_t rows, uint8_t cols);
+
+/**
+ * Creates a view on a range of rows of a matrix.
+ *
+ * @param [out] V    pointer to matrix to hold the view
+ * @param [in]  A    pointer to the viewed matrix
+ * @param [in]  r    first row of the range
+ * @param [in]  rows number of rows of the range
+ * @return returns the pointer to the view on success, NULL otherwise
+ */
+eekf_mat* eekf_mat_rows(eekf_mat *V, eekf_mat const *A, uint8_t r, uint8_t rows);
+
+/**
+ * Creates a view on a range of columns of a matrix.
+ *
+ * @param [out] V    pointer to matrix to hold the view
+ * @param [in]  A    pointer to the viewed matrix
+ * @param [in]  c    first column of the range
+ * @param [in]  cols number of columns of the range
+ * @return returns the pointer to the view on success, NULL otherwise
+ */
+eekf_mat* eekf_mat_cols(eekf_mat *V, eekf_mat const *A, uint8_t c, uint8_t cols);
+
+/**
+ * Creates a view on the diagonal of a matrix.
+ *
+ * The diagonal is viewed as row vector with one element per diagonal element.
+ *
+ * @param [out] V pointer to matrix to hold the view
+ * @param [in]  A pointer to the viewed matrix
+ * @return returns the pointer to the view on success, NULL otherwise
+ */
+eekf_mat* eekf_mat_diag(eekf_mat *V, eekf_mat const *A);
+
+/**
+ * Copies a matrix such that B = A.
+ *
+ * @param [out] B pointer to matrix to hold the result
+ * @param [in]  A pointer to matrix to be copied
+ * @return returns the pointer to result matrix on success, NULL otherwise
+ */
+eekf_mat* eekf_mat_copy(eekf_mat *B, eekf_mat const *A);
 
 /**
  * Multiply two matrices such that C = A * B.
@@ -144,4 +479,17 @@ eekf_mat* eekf_mat_chol(eekf_mat *L, eekf_mat const *A);
  */
 eekf_mat* eekf_mat_fw_sub(eekf_mat *X, eekf_mat const *L, eekf_mat const *B);
 
+#ifdef EEKF_FIXED
+/**
+ * Computes the number of unused integer bits of a fixed-point matrix.
+ *
+ * The headroom is the number of times the largest magnitude element can be doubled without
+ * saturating. A headroom of 0 indicates saturation or its imminent risk.
+ *
+ * @param [in] A pointer to the matrix
+ * @return returns the headroom in bits
+ */
+uint8_t eekf_mat_headroom(eekf_mat const *A);
+#endif
+
 #endif /* EEKF_MAT_H */
@@ -0,0 +1,101 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+
+/**
+ * Monte Carlo consistency harness for tuning filter noise covariances.
+ *
+ * The harness simulates a truth model with known noise, runs the filter against the simulated
+ * measurements and accumulates the normalized estimation error squared (NEES), the normalized
+ * innovation squared (NIS) and the root mean squared error (RMSE) of the filter over many
+ * independent trials. Trials are distributed over several threads. Every trial draws its noise
+ * from its own random number stream, so a trial yields the same result regardless of the thread
+ * it runs on. No trajectories are stored, all statistics are accumulated online.
+ *
+ * All callbacks are invoked concurrently from multiple threads and must be reentrant.
+ *
+ * @copyright	The MIT Licence
+ * @file		eekf_mc.h
+ * @author 		Christian Meißner
+ */
+
+#ifndef EEKF_MC_H
+#define EEKF_MC_H
+
+#include <eekf/eekf.h>
+
+/// Monte Carlo simulation setup
+typedef struct
+{
+	ekkf_fun_f truthF;			//!< state transition function of the truth model (Jacobian is ignored)
+	ekkf_fun_h truthH;			//!< measurement function of the truth model (Jacobian is ignored)
+	void *truthUserData;		//!< pointer to user defined data of the truth model
+
+	ekkf_fun_f f;				//!< state transition function of the filter
+	ekkf_fun_h h;				//!< measurement prediction function of the filter
+	void *userData;				//!< pointer to user defined data of the filter
+
+	eekf_mat const *x0;			//!< initial state of the filter and mean initial true state (N x 1)
+	eekf_mat const *P0;			//!< initial covariance of the filter (N x N)
+	eekf_mat const *x0Sqrt;		//!< factor of the initial true state spread, P = x0Sqrt * x0Sqrt' (N x L)
+	eekf_mat const *u;			//!< constant input of truth model and filter
+
+	eekf_mat const *Q;			//!< process noise covariance of the filter (N x N)
+	eekf_mat const *R;			//!< measurement noise covariance of the filter (M x M)
+	eekf_mat const *QtSqrt;		//!< factor of the true process noise, Qt = QtSqrt * QtSqrt' (N x L)
+	eekf_mat const *RtSqrt;		//!< factor of the true measurement noise, Rt = RtSqrt * RtSqrt' (M x L)
+
+	uint32_t steps;				//!< number of correction/prediction steps per trial
+	uint32_t trials;			//!< number of independent trials
+	uint64_t seed;				//!< seed of the random number streams
+	uint8_t threads;			//!< number of threads, 0 uses all online processors
+} eekf_mc_config;
+
+/// Monte Carlo simulation results
+typedef struct
+{
+	uint32_t trials;	//!< number of completed trials the statistics are based on
+	uint32_t failed;	//!< number of trials aborted due to a failing filter step
+	eekf_value nees;	//!< average NEES over all steps and trials, should be close to N
+	eekf_value nis;		//!< average NIS over all steps and trials, should be close to M
+	eekf_mat *rmse;		//!< optional per state RMSE over all steps and trials (N x 1)
+} eekf_mc_result;
+
+/**
+ * Run a Monte Carlo simulation.
+ *
+ * Each trial draws the initial true state from x0 and x0Sqrt and starts the filter at x0 with
+ * covariance P0. Then in each step it simulates a measurement, corrects the filter, accumulates
+ * the statistics of the corrected estimate and predicts truth and filter to the next step.
+ * Trials with a failing filter step are excluded from the statistics and counted as failed.
+ *
+ * The statistics of the individual trials are deterministic. Their sums may differ in the last
+ * bits for different thread counts due to a different summation order.
+ *
+ * @param [out] res	pointer to the results, res->rmse may point to a matrix to hold the RMSE
+ * @param [in]	cfg	pointer to the simulation setup
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_mc_run(eekf_mc_result *res, eekf_mc_config const *cfg);
+
+#endif /* EEKF_MC_H */
@@ -0,0 +1,166 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+/**
+ * Published estimate for lock-free concurrent reads of the filter state.
+ *
+ * A published estimate holds two copies of the state x and covariance P, each guarded by a
+ * sequence number (seqlock). When a publication is attached to a filter context, every successful
+ * predict and correct step writes the new estimate to the copy readers are not directed to and then
+ * flips the latest index to it. Any number of reader threads get a consistent snapshot of the
+ * latest estimate together with its time stamp and step counter. The filter thread never waits
+ * for readers, and readers only retry if the filter publishes twice while they are copying.
+ *
+ * Publications can be attached to extended Kalman filter contexts, sigma-point filter contexts
+ * (eekf_sp.h) and IMM filters (eekf_imm.h), the latter publish their combined estimate. The tracks of the multi-target
+ * tracker are not published, the track set changes with every scan. A failing publication never
+ * fails the filter step, it is counted in the publication instead.
+ *
+ * The writer uses atomic loads, stores and fences only, no read-modify-write operations, so it
+ * also works on cores without exclusive access instructions. There must be a single writer, i.e.
+ * the thread running the filter.
+ *
+ * @copyright	The MIT Licence
+ * @file		eekf_publish.h
+ * @author 		Christian Meißner
+ */
+
+#ifndef EEKF_PUBLISH_H
+#define EEKF_PUBLISH_H
+
+#include <eekf/eekf.h>
+
+/// declare the storage of a published estimate with the given number of states
+#define EEKF_PUBLISH_DECL_STORAGE(name, states)\
+	eekf_value name##_values[2*((states)+(states)*(states))];
+
+/// one copy of the published estimate
+typedef struct
+{
+	uint32_t seq;		//!< sequence number, odd while the copy is written
+	uint32_t step;		//!< step counter of the estimate
+	eekf_value t;		//!< time stamp of the estimate
+	eekf_value *x;		//!< state (packed, states x 1)
+	eekf_value *P;		//!< covariance (packed, states x states)
+} eekf_publish_slot;
+
+/// published estimate
+typedef struct eekf_publish
+{
+	eekf_publish_slot slots[2];	//!< the two copies of the estimate
+	uint32_t latest;			//!< index of the copy holding the latest estimate
+	uint32_t step;				//!< number of publications
+	uint32_t failed;			//!< number of failed publications (written by the filter thread)
+	eekf_value t;				//!< time stamp of the next publication
+	uint8_t states;				//!< number of states
+} eekf_publish;
+
+/**
+ * Initialize a published estimate.
+ *
+ * @param [out] pub		pointer to the published estimate to initialize
+ * @param [in]	values	pointer to 2 * (states + states * states) values holding the copies
+ * @param [in]	states	number of states
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_publish_init(eekf_publish *pub, eekf_value *values,
+		uint8_t states);
+
+/**
+ * Attach a published estimate to a filter context.
+ *
+ * The current estimate of the context is published right away with step counter 0, so readers
+ * always find a valid estimate. Passing NULL detaches the current publication.
+ *
+ * @param [in/out] ctx	pointer to the filter context
+ * @param [in/out] pub	pointer to the published estimate (may be NULL)
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_publish_attach(eekf_context *ctx, eekf_publish *pub);
+
+/**
+ * Attach a published estimate to the estimate of a filter.
+ *
+ * Used by the attach functions of the other filters, behaves like eekf_publish_attach().
+ *
+ * @param [out]	   publish	pointer to the publication pointer of the filter
+ * @param [in]	   x		pointer to the state of the filter
+ * @param [in]	   P		pointer to the covariance of the filter
+ * @param [in/out] pub		pointer to the published estimate (may be NULL)
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_publish_attach_estimate(struct eekf_publish **publish,
+		eekf_mat const *x, eekf_mat const *P, eekf_publish *pub);
+
+/**
+ * Set the time stamp of subsequent publications.
+ *
+ * Must be called from the filter thread, e.g. before predicting to a new time.
+ *
+ * @param [in/out] pub	pointer to the published estimate
+ * @param [in]	   t	time stamp
+ */
+void eekf_publish_set_time(eekf_publish *pub, eekf_value t);
+
+/**
+ * Publish the estimate of a filter step.
+ *
+ * Called by the filter functions at the end of each successful step, does nothing if pub is NULL.
+ * A failed publication is counted in pub->failed and does not fail the step. Must only be called
+ * from the filter thread.
+ *
+ * @param [in/out] pub	pointer to the published estimate (may be NULL)
+ * @param [in]	   x	pointer to the state
+ * @param [in]	   P	pointer to the covariance
+ */
+void eekf_publish_step(eekf_publish *pub, eekf_mat const *x, eekf_mat const *P);
+
+/**
+ * Publish an estimate.
+ *
+ * Must only be called from the filter thread.
+ *
+ * @param [in/out] pub	pointer to the published estimate
+ * @param [in]	   x	pointer to the state
+ * @param [in]	   P	pointer to the covariance
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_publish_write(eekf_publish *pub, eekf_mat const *x,
+		eekf_mat const *P);
+
+/**
+ * Read a consistent snapshot of the latest published estimate.
+ *
+ * May be called from any thread concurrently. The function never blocks the filter thread.
+ *
+ * @param [in]  pub		pointer to the published estimate
+ * @param [out] x		pointer to the matrix that will hold the state (may be NULL)
+ * @param [out] P		pointer to the matrix that will hold the covariance (may be NULL)
+ * @param [out] t		pointer to the time stamp (may be NULL)
+ * @param [out] step	pointer to the step counter (may be NULL)
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_publish_read(eekf_publish const *pub, eekf_mat *x,
+		eekf_mat *P, eekf_value *t, uint32_t *step);
+
+#endif /* EEKF_PUBLISH_H */
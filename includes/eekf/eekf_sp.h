@@ -0,0 +1,172 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+
+/**
+ * Functions to compute filter states of a derivative-free sigma-point (unscented/cubature) filter.
+ *
+ * The filter propagates 2N+1 sigma points through the state transition and measurement functions
+ * instead of linearizing them, so no Jacobians are required. The functions are evaluated on all
+ * sigma points in a single callback invocation, the points are passed as columns of a matrix.
+ *
+ * @copyright	The MIT Licence
+ * @file		eekf_sp.h
+ * @author 		Christian Meißner
+ */
+
+#ifndef EEKF_SP_H
+#define EEKF_SP_H
+
+#include <eekf/eekf.h>
+
+/**
+ * Function type to compute the predicted states of all sigma points.
+ *
+ * The function f takes the sigma points X and the current input variables to compute the
+ * predicted sigma points Xp. Column j of Xp is the prediction of column j of X.
+ *
+ * @param [out] Xp			pointer to the matrix that will hold the predicted points (N x 2N+1)
+ * @param [in]	X			pointer to the matrix holding the sigma points (N x 2N+1)
+ * @param [in]	u			pointer to the matrix holding the current input variables
+ * @param [in]	userData	pointer to the optional user data
+ * @return should return eEekfReturnOk if computation succeeded
+ */
+typedef eekf_return (*eekf_sp_fun_f)(eekf_mat *Xp, eekf_mat const *X,
+		eekf_mat const *u, void *userData);
+
+/**
+ * Function type to compute the predicted measurements of all sigma points.
+ *
+ * Column j of Z is the measurement prediction of column j of X.
+ *
+ * @param [out]	Z			pointer to the matrix that will hold the measurements (M x 2N+1)
+ * @param [in]	X			pointer to the matrix holding the sigma points (N x 2N+1)
+ * @param [in]  userData	pointer to the optional user data
+ * @return	should return eEekfReturnOk if computation succeeded
+ */
+typedef eekf_return (*eekf_sp_fun_h)(eekf_mat *Z, eekf_mat const *X,
+		void *userData);
+
+/// the sigma-point filter context
+typedef struct
+{
+	eekf_mat *x; 		//!< predicted/corrected state
+	eekf_mat *P;		//!< predicted/corrected covariance
+	eekf_sp_fun_f f;	//!< batched state transition function
+	eekf_sp_fun_h h;	//!< batched measurement prediction function
+	void *userData; 	//!< pointer to user defined data
+	struct eekf_publish *publish;	//!< optional published estimate updated by every step
+	eekf_value alpha;	//!< sigma-point spread
+	eekf_value beta;	//!< prior distribution parameter (2 is optimal for gaussian priors)
+	eekf_value kappa;	//!< secondary scaling parameter
+} eekf_sp_context;
+
+/**
+ * Initialize sigma-point filter context.
+ *
+ * The context layout and parameters match eekf_init(). The sigma-point parameters are set to
+ * alpha = 1, beta = 0, kappa = 0, which is the cubature rule: the center point gets zero
+ * weight and the remaining 2N points are equally weighted. Use eekf_sp_set_params() to select
+ * a different unscented transformation.
+ *
+ * @param [in/out] ctx 		pointer to the context to initialize
+ * @param [in]	   x 		pointer to the matrix holding the current state
+ * @param [in]	   P		pointer to the matrix holding the current covariance
+ * @param [in]	   f		function pointer to the batched state transition function
+ * @param [in]	   h		function pointer to the batched measurement prediction function
+ * @param [in]	   userData	optional pointer to user data
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_sp_init(eekf_sp_context *ctx, eekf_mat *x, eekf_mat *P,
+		eekf_sp_fun_f f, eekf_sp_fun_h h, void *userData);
+
+/**
+ * Set the parameters of the scaled unscented transformation.
+ *
+ * The sigma points are spread by sqrt(N + lambda) with lambda = alpha^2 * (N + kappa) - N.
+ * N + lambda must be positive.
+ *
+ * @param [in/out] ctx		pointer to the filter context
+ * @param [in]	   alpha	sigma-point spread
+ * @param [in]	   beta		prior distribution parameter
+ * @param [in]	   kappa	secondary scaling parameter
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_sp_set_params(eekf_sp_context *ctx, eekf_value alpha,
+		eekf_value beta, eekf_value kappa);
+
+/**
+ * Attach a published estimate to a sigma-point filter context.
+ *
+ * Behaves like eekf_publish_attach() (see eekf_publish.h).
+ *
+ * @param [in/out] ctx	pointer to the sigma-point filter context
+ * @param [in/out] pub	pointer to the published estimate (may be NULL)
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_publish_attach_sp(eekf_sp_context *ctx,
+		struct eekf_publish *pub);
+
+/**
+ * Predict the next filter state.
+ *
+ * The sigma points are generated from the Cholesky factor of P and propagated with a single call
+ * of f. The dimension of noise covariance Q should match the dimensions of context P.
+ *
+ * @param [in/out] ctx	pointer to the filter context
+ * @param [in] 	   u	pointer to the matrix holding input values
+ * @param [in]	   Q	pointer to the matrix holding the process covariance
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_sp_predict(eekf_sp_context *ctx, eekf_mat const *u,
+		eekf_mat const *Q);
+
+/**
+ * Correct the current filter state.
+ *
+ * The measurement predictions of all sigma points are computed with a single call of h.
+ * The dimensions of z and R must match: DIM(z) = M x 1, DIM(R) = M x M.
+ *
+ * @param [in/out] ctx	pointer to the filter context
+ * @param [in]	   z	pointer to the matrix holding the measurement values
+ * @param [in]	   R	pointer to the matrix holding the measurement covariance
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_sp_correct(eekf_sp_context *ctx, eekf_mat const *z,
+		eekf_mat const *R);
+
+/**
+ * Correct the current filter state and report the innovation statistics.
+ *
+ * @see eekf_correct_innovation()
+ *
+ * @param [in/out] ctx	pointer to the filter context
+ * @param [in]	   z	pointer to the matrix holding the measurement values
+ * @param [in]	   R	pointer to the matrix holding the measurement covariance
+ * @param [out]	   inno	pointer to the innovation statistics (may be NULL)
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_sp_correct_innovation(eekf_sp_context *ctx, eekf_mat const *z,
+		eekf_mat const *R, eekf_innovation *inno);
+
+#endif /* EEKF_SP_H */
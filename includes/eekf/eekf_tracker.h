@@ -0,0 +1,262 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+/**
+ * Multi-target tracker running one extended Kalman filter per track.
+ *
+ * Every scan predicts all tracks, gates the measurements of the scan against the tracks, assigns
+ * measurements to tracks by global nearest neighbour (GNN) association and corrects the assigned
+ * tracks. Measurements are bucketed into a spatially hashed uniform grid over two measurement
+ * components, each track only visits the cells overlapped by the bounding box of its gate, so the
+ * scan cost grows with the number of tracks and measurements instead of their product.
+ *
+ * The innovation covariance S of every track is computed and factorized once per scan and reused
+ * for the gating distances of all candidate measurements, which are computed in batches with one
+ * forward substitution, and for the correction. The association is solved with the auction
+ * algorithm over the gated pairs, a track may also stay unassigned at the cost of the gate
+ * threshold. Predictions, gating and corrections are distributed over a pool of worker threads
+ * started once by eekf_tracker_init() and stopped by eekf_tracker_close(), the thread calling
+ * eekf_tracker_scan() runs a share of the tracks itself.
+ *
+ * No memory is allocated, the user provides the track and measurement pools. The callbacks are
+ * invoked concurrently from multiple threads and must be reentrant.
+ *
+ * @copyright	The MIT Licence
+ * @file		eekf_tracker.h
+ * @author 		Christian Meißner
+ */
+
+#ifndef EEKF_TRACKER_H
+#define EEKF_TRACKER_H
+
+#include <eekf/eekf.h>
+
+#include <pthread.h>
+
+/// maximum number of gated measurements kept per track, the ones closest to the track are kept
+#define EEKF_TRACKER_MAX_GATED 8
+
+/// number of candidate measurements whose gating distances are computed together
+#define EEKF_TRACKER_BATCH 16
+
+/// maximum number of threads of a tracker including the calling thread
+#define EEKF_TRACKER_MAX_THREADS 16
+
+/// number of values of a track with given number of states and measurement dimension
+#define EEKF_TRACKER_TRACK_SIZE(states, dim)\
+	((states) + (states) * (states) + (dim) + (states) * (dim) + (dim) * (dim))
+
+/// declare the pools of a tracker
+#define EEKF_TRACKER_DECL_STORAGE(name, tracks, measurements, buckets, states, dim)\
+	eekf_tracker_track name##_tracks[(tracks)];\
+	eekf_value name##_values[(tracks) * EEKF_TRACKER_TRACK_SIZE(states, dim)];\
+	eekf_tracker_meas name##_meas[(measurements)];\
+	uint32_t name##_buckets[(buckets) + 1];
+
+/// tracker configuration
+typedef struct
+{
+	ekkf_fun_f f;			//!< state transition function of all tracks
+	ekkf_fun_h h;			//!< measurement prediction function of all tracks
+	void *userData;			//!< pointer to user defined data passed to f and h
+	uint8_t states;			//!< number of states N
+	uint8_t dim;			//!< measurement dimension M
+	uint8_t axes[2];		//!< measurement components spanning the grid (equal for M = 1)
+	eekf_value cellSize;	//!< edge length of a grid cell, in the order of a typical gate size
+	eekf_value gamma;		//!< gate threshold on the squared Mahalanobis distance
+	eekf_value epsilon;		//!< auction bid increment, the assignment cost is within epsilon per track of the optimum
+	uint8_t threads;		//!< number of threads, 0 uses all online processors (at most EEKF_TRACKER_MAX_THREADS)
+} eekf_tracker_config;
+
+/// track
+typedef struct
+{
+	eekf_context ctx;		//!< filter context
+	eekf_mat x;				//!< state
+	eekf_mat P;				//!< covariance
+	eekf_mat zp;			//!< predicted measurement of the current scan
+	eekf_mat PJht;			//!< cross covariance P * Jh' of the current scan
+	eekf_mat L;				//!< Cholesky factor of the innovation covariance of the current scan
+	uint32_t id;			//!< unique track id
+	uint32_t hits;			//!< number of scans with assigned measurement
+	uint32_t misses;		//!< number of consecutive scans without assigned measurement
+	int32_t meas;			//!< measurement assigned in the current scan, -1 if none
+	eekf_return status;		//!< result of the prediction and correction of the current scan
+	uint32_t gated;			//!< number of measurements inside the gate in the current scan
+	uint8_t nGated;			//!< number of kept gated measurements
+	uint32_t gatedMeas[EEKF_TRACKER_MAX_GATED];		//!< kept gated measurements
+	eekf_value gatedCost[EEKF_TRACKER_MAX_GATED];	//!< squared Mahalanobis distances of them
+	int32_t next;			//!< auction queue link (tracker internal)
+} eekf_tracker_track;
+
+/// measurement working data (tracker internal)
+typedef struct
+{
+	int64_t cell[2];		//!< grid cell of the measurement
+	uint32_t bucket;		//!< hash bucket of the cell
+	uint32_t sorted;		//!< measurement at this position of the bucket order
+	int32_t owner;			//!< track the measurement is assigned to, -1 if none
+	eekf_value price;		//!< auction price
+} eekf_tracker_meas;
+
+/// scan statistics
+typedef struct
+{
+	uint32_t measurements;	//!< number of measurements of the scan
+	uint32_t candidates;	//!< number of track-measurement pairs whose distance was computed
+	uint32_t gated;			//!< number of pairs inside the gate
+	uint32_t truncated;		//!< number of gated pairs dropped beyond EEKF_TRACKER_MAX_GATED per track
+	uint32_t bids;			//!< number of auction bids
+	uint32_t assigned;		//!< number of corrected tracks
+	uint32_t missed;		//!< number of tracks without measurement
+	uint32_t unassigned;	//!< number of measurements not assigned to a track
+	uint32_t failed;		//!< number of tracks with failed prediction or correction
+} eekf_tracker_stats;
+
+struct eekf_tracker;
+
+/// worker thread state and statistics accumulator (tracker internal)
+typedef struct
+{
+	struct eekf_tracker *tr;	//!< tracker
+	eekf_mat const *u;			//!< input variables of the scan
+	eekf_mat const *Q;			//!< process noise covariance of the scan
+	eekf_value const *Z;		//!< measurements of the scan
+	uint32_t nMeas;				//!< number of measurements of the scan
+	eekf_mat const *R;			//!< measurement noise covariance of the scan
+	uint32_t first;				//!< first track of the worker
+	uint32_t stride;			//!< track index increment of the worker
+	uint8_t correct;			//!< run corrections instead of predictions and gating
+	uint8_t started;			//!< the worker runs on its own thread
+	pthread_t id;				//!< thread of the worker
+	eekf_tracker_stats stats;	//!< statistics of the tracks of the worker
+} eekf_tracker_worker;
+
+/// worker thread pool (tracker internal)
+typedef struct
+{
+	eekf_tracker_worker workers[EEKF_TRACKER_MAX_THREADS];	//!< workers, the first one is the calling thread
+	uint8_t nWorkers;		//!< number of workers
+	uint8_t nStarted;		//!< number of workers running on their own thread
+	uint8_t stop;			//!< set to stop the threads
+	uint32_t phase;			//!< number of dispatched phases
+	uint32_t pending;		//!< number of threads still running the current phase
+	pthread_mutex_t lock;	//!< guards stop, phase and pending
+	pthread_cond_t start;	//!< signals a new phase or stop to the threads
+	pthread_cond_t done;	//!< signals the end of a phase to the calling thread
+} eekf_tracker_pool;
+
+/// the tracker, must not be copied or moved while initialized
+typedef struct eekf_tracker
+{
+	eekf_tracker_config cfg;		//!< configuration
+	eekf_tracker_track *tracks;		//!< track pool
+	eekf_value *values;				//!< values of the track pool
+	uint32_t nTracks;				//!< number of active tracks
+	uint32_t maxTracks;				//!< capacity of the track pool
+	eekf_tracker_meas *meas;		//!< measurement pool
+	uint32_t maxMeas;				//!< capacity of the measurement pool
+	uint32_t *buckets;				//!< start of every hash bucket in the bucket order
+	uint32_t nBuckets;				//!< number of hash buckets
+	uint32_t nextId;				//!< id of the next track
+	eekf_tracker_stats stats;		//!< statistics of the last scan
+	eekf_tracker_pool pool;			//!< worker threads
+} eekf_tracker;
+
+/**
+ * Initialize a tracker and start its worker threads.
+ *
+ * Threads which cannot be started leave their share of the tracks to the calling thread. Call
+ * eekf_tracker_close() to stop the threads.
+ *
+ * @param [out] tr			pointer to the tracker to initialize
+ * @param [in]	cfg			pointer to the configuration
+ * @param [in]	tracks		pointer to maxTracks tracks
+ * @param [in]	values		pointer to maxTracks * EEKF_TRACKER_TRACK_SIZE(states, dim) values
+ * @param [in]	maxTracks	capacity of the track pool
+ * @param [in]	meas		pointer to maxMeas measurement working data
+ * @param [in]	maxMeas		maximum number of measurements per scan
+ * @param [in]	buckets		pointer to nBuckets + 1 bucket starts
+ * @param [in]	nBuckets	number of hash buckets, must be a power of two
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_tracker_init(eekf_tracker *tr, eekf_tracker_config const *cfg,
+		eekf_tracker_track *tracks, eekf_value *values, uint32_t maxTracks,
+		eekf_tracker_meas *meas, uint32_t maxMeas, uint32_t *buckets,
+		uint32_t nBuckets);
+
+/**
+ * Stop the worker threads of a tracker.
+ *
+ * The tracker has to be initialized again before it can be used afterwards.
+ *
+ * @param [in/out] tr	pointer to the tracker
+ */
+void eekf_tracker_close(eekf_tracker *tr);
+
+/**
+ * Start a new track.
+ *
+ * @param [in/out] tr	pointer to the tracker
+ * @param [in]	   x0	pointer to the matrix holding the initial state
+ * @param [in]	   P0	pointer to the matrix holding the initial covariance
+ * @param [out]	   id	pointer to the id of the new track (may be NULL)
+ * @return returns eEekfReturnOk on success, eEekfReturnQueueFull if the track pool is full
+ */
+eekf_return eekf_tracker_add(eekf_tracker *tr, eekf_mat const *x0,
+		eekf_mat const *P0, uint32_t *id);
+
+/**
+ * Delete a track.
+ *
+ * The last track takes the place of the deleted one, so iterate backwards when deleting tracks
+ * in a loop.
+ *
+ * @param [in/out] tr		pointer to the tracker
+ * @param [in]	   index	index of the track in the track pool
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_tracker_remove(eekf_tracker *tr, uint32_t index);
+
+/**
+ * Process a scan of measurements.
+ *
+ * Predicts all tracks, associates the measurements with the tracks and corrects the tracks with
+ * their assigned measurement. The assigned measurement of each track is reported in its meas
+ * field, the statistics of the scan in the stats field of the tracker.
+ *
+ * @param [in/out] tr			pointer to the tracker
+ * @param [in]	   u			pointer to the matrix holding input values
+ * @param [in]	   Q			pointer to the matrix holding the process covariance
+ * @param [in]	   Z			pointer to the measurement values, M values per measurement
+ * @param [in]	   nMeas		number of measurements K
+ * @param [in]	   R			pointer to the matrix holding the measurement covariance
+ * @param [out]	   unassigned	pointer to K indices receiving the measurements not assigned to
+ * 								a track (may be NULL), their number is stats.unassigned
+ * @return returns eEekfReturnOk on success
+ */
+eekf_return eekf_tracker_scan(eekf_tracker *tr, eekf_mat const *u,
+		eekf_mat const *Q, eekf_value const *Z, uint32_t nMeas,
+		eekf_mat const *R, uint32_t *unassigned);
+
+#endif /* EEKF_TRACKER_H */
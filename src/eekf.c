@@ -31,6 +31,7 @@
  */
 
 #include <eekf/eekf.h>
+#include <eekf/eekf_publish.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -56,6 +57,9 @@ eekf_return eekf_init(eekf_context *ctx, eekf_mat *x, eekf_mat *P, ekkf_fun_f f,
     // user defined data
     ctx->userData = userData;
 
+    // no published estimate
+    ctx->publish = NULL;
+
     return eEekfReturnOk;
 }
 
@@ -79,8 +83,10 @@ eekf_return eekf_predict(eekf_context *ctx, eekf_mat const *u,
         return eEekfReturnCallbackFailed;
     }
     // copy prediction to state
-    memcpy(ctx->x->elements, xp.elements,
-            sizeof(eekf_value) * ctx->x->rows * ctx->x->cols);
+    if (NULL == eekf_mat_copy(ctx->x, &xp))
+    {
+        return eEekfReturnComputationFailed;
+    }
 
     // predict covariance Pp = A*P*A' + Q
     if (NULL
@@ -91,30 +97,50 @@ eekf_return eekf_predict(eekf_context *ctx, eekf_mat const *u,
         return eEekfReturnComputationFailed;
     }
 
+    eekf_publish_step(ctx->publish, ctx->x, ctx->P);
     return eEekfReturnOk;
 }
 
 eekf_return eekf_correct(eekf_context *ctx, eekf_mat const *z,
         eekf_mat const *R)
 {
-    if (NULL == R || NULL == z || NULL == ctx || z->rows != R->rows
-            || z->rows != R->cols)
+    return eekf_correct_innovation(ctx, z, R, NULL);
+}
+
+eekf_return eekf_correct_innovation(eekf_context *ctx, eekf_mat const *z,
+        eekf_mat const *R, eekf_innovation *inno)
+{
+    if (NULL == R || NULL == z || NULL == ctx)
     {
         return eEekfReturnParameterError;
     }
 
     // predicted measurement
     EEKF_DECL_MAT_DYN(zp, z->rows, z->cols);
-    // measurement linearization
-    EEKF_DECL_MAT_DYN(Jh, z->rows, ctx->x->rows);
     // helper matrices
     EEKF_DECL_MAT_DYN(PJht, ctx->x->rows, z->rows);
     EEKF_DECL_MAT_DYN(L, z->rows, z->rows);
-    EEKF_DECL_MAT_DYN(U, z->rows, ctx->x->rows);
+    eekf_return ret = eekf_correct_factor(ctx, z, R, &zp, &PJht, &L);
+
+    return eEekfReturnOk != ret ? ret :
+            eekf_correct_factored(ctx, z, &zp, &PJht, &L, inno);
+}
+
+eekf_return eekf_correct_factor(eekf_context const *ctx, eekf_mat const *z,
+        eekf_mat const *R, eekf_mat *zp, eekf_mat *PJht, eekf_mat *L)
+{
+    if (NULL == R || NULL == z || NULL == ctx || NULL == zp || NULL == PJht
+            || NULL == L || z->rows != R->rows || z->rows != R->cols)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    // measurement linearization
+    EEKF_DECL_MAT_DYN(Jh, z->rows, ctx->x->rows);
 
     // predict measurement and linearize measurement: zp = h(x), Jh = dh(x)/dx
     if (NULL != ctx->h
-            && eEekfReturnOk != ctx->h(&zp, &Jh, ctx->x, ctx->userData))
+            && eEekfReturnOk != ctx->h(zp, &Jh, ctx->x, ctx->userData))
     {
         return eEekfReturnCallbackFailed;
     }
@@ -122,7 +148,7 @@ eekf_return eekf_correct(eekf_context *ctx, eekf_mat const *z,
     {
         EEKF_DECL_MAT_DYN(Ct, Jh.cols, Jh.rows);
         // cross covariance
-        if (NULL == eekf_mat_mul(&PJht, ctx->P, eekf_mat_trs(&Ct, &Jh)))
+        if (NULL == eekf_mat_mul(PJht, ctx->P, eekf_mat_trs(&Ct, &Jh)))
         {
             return eEekfReturnComputationFailed;
         }
@@ -133,22 +159,39 @@ eekf_return eekf_correct(eekf_context *ctx, eekf_mat const *z,
     {
         EEKF_DECL_MAT_DYN(S, R->rows, R->cols);
         // cholesky factorization
-        if (NULL == eekf_mat_chol(&L, eekf_mat_add( // innovation covariance
-                &S, eekf_mat_mul(&S, &Jh, &PJht), R)))
+        if (NULL == eekf_mat_chol(L, eekf_mat_add( // innovation covariance
+                &S, eekf_mat_mul(&S, &Jh, PJht), R)))
         {
             return eEekfReturnComputationFailed;
         }
     }
 
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_correct_factored(eekf_context *ctx, eekf_mat const *z,
+        eekf_mat const *zp, eekf_mat const *PJht, eekf_mat const *L,
+        eekf_innovation *inno)
+{
+    if (NULL == ctx || NULL == z || NULL == zp || NULL == PJht || NULL == L
+            || zp->rows != z->rows || PJht->rows != ctx->x->rows
+            || PJht->cols != z->rows || L->rows != z->rows
+            || L->cols != z->rows)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    EEKF_DECL_MAT_DYN(U, z->rows, ctx->x->rows);
+
     // compute intermediate matrix for computational efficiency
     // K = U / L -> U = (L \ PJh')'
     {
-        EEKF_DECL_MAT_DYN(PCtt, PJht.cols, PJht.rows);
+        EEKF_DECL_MAT_DYN(PCtt, PJht->cols, PJht->rows);
         EEKF_DECL_MAT_DYN(LPCtt, z->rows, ctx->x->rows);
         if (NULL
                 == eekf_mat_trs(&U,
-                        eekf_mat_fw_sub(&LPCtt, &L,
-                                eekf_mat_trs(&PCtt, &PJht))))
+                        eekf_mat_fw_sub(&LPCtt, L,
+                                eekf_mat_trs(&PCtt, PJht))))
         {
             return eEekfReturnComputationFailed;
         }
@@ -164,11 +207,14 @@ eekf_return eekf_correct(eekf_context *ctx, eekf_mat const *z,
         if (NULL
                 == eekf_mat_add(ctx->x, ctx->x,
                         eekf_mat_mul(&cx, &U,
-                                eekf_mat_fw_sub(&Ldz, &L,
-                                        eekf_mat_sub(&dz, z, &zp)))))
+                                eekf_mat_fw_sub(&Ldz, L,
+                                        eekf_mat_sub(&dz, z, zp)))))
         {
             return eEekfReturnComputationFailed;
         }
+
+        // innovation statistics
+        eekf_innovation_compute(inno, L, &Ldz);
     }
 
     // correct covariance
@@ -185,18 +231,331 @@ eekf_return eekf_correct(eekf_context *ctx, eekf_mat const *z,
         }
     }
 
+    eekf_publish_step(ctx->publish, ctx->x, ctx->P);
+    return eEekfReturnOk;
+}
+
+eekf_innovation* eekf_innovation_compute(eekf_innovation *inno,
+        eekf_mat const *L, eekf_mat const *Ldz)
+{
+    if (NULL == inno || NULL == L || NULL == Ldz || L->rows != Ldz->rows)
+    {
+        return NULL;
+    }
+
+    // nis = |L \ (z - zp)|^2, log(det(S)) = 2 * sum(log(diag(L)))
+    uint8_t i;
+    inno->nis = 0;
+    inno->logDetS = 0;
+    for (i = 0; i < L->rows; i++)
+    {
+        eekf_wide logL = EEKF_VALUE_LOG_WIDE(*EEKF_MAT_EL(*L, i, i));
+        inno->nis += EEKF_MUL_WIDE(*EEKF_MAT_EL(*Ldz, i, 0),
+                *EEKF_MAT_EL(*Ldz, i, 0));
+        inno->logDetS += logL + logL;
+    }
+
+    return inno;
+}
+
+// mark the given active state indices in flags, fails on invalid or duplicate indices
+static uint8_t* eekf_mark_active(uint8_t *flags, uint8_t N,
+        uint8_t const *active, uint8_t nActive)
+{
+    uint8_t i;
+
+    memset(flags, 0, N);
+    for (i = 0; i < nActive; i++)
+    {
+        if (active[i] >= N || flags[active[i]])
+        {
+            return NULL;
+        }
+        flags[active[i]] = 1;
+    }
+
+    return flags;
+}
+
+eekf_return eekf_predict_partial(eekf_context *ctx, eekf_mat const *u,
+        eekf_mat const *Q, uint8_t const *active, uint8_t nActive)
+{
+    if (NULL == Q || NULL == u || NULL == ctx
+            || (NULL == active && nActive > 0) || Q->rows != ctx->x->rows
+            || Q->cols != ctx->x->rows)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    uint8_t N = ctx->x->rows;
+    uint8_t isActive[N];
+    uint8_t i, l, j, m;
+
+    if (NULL == eekf_mark_active(isActive, N, active, nActive))
+    {
+        return eEekfReturnParameterError;
+    }
+    // everything frozen
+    if (0 == nActive)
+    {
+        return eEekfReturnOk;
+    }
+
+    EEKF_DECL_MAT_DYN(Jf, N, N);
+    EEKF_DECL_MAT_DYN(xp, N, 1);
+    EEKF_DECL_MAT_DYN(A, nActive, N);
+
+    // predict state and linearize system: x1 = f(x,u), Jf = df(x,u)/dx
+    if (NULL != ctx->f
+            && eEekfReturnOk != ctx->f(&xp, &Jf, ctx->x, u, ctx->userData))
+    {
+        return eEekfReturnCallbackFailed;
+    }
+    // copy prediction of active states to state
+    for (i = 0; i < nActive; i++)
+    {
+        *EEKF_MAT_EL(*ctx->x, active[i], 0) = *EEKF_MAT_EL(xp, active[i], 0);
+    }
+
+    // active rows of Jf times P: A = Jf_a * P, skipping zeros of Jf
+    for (i = 0; i < nActive; i++)
+    {
+        for (j = 0; j < N; j++)
+        {
+            eekf_acc acc = 0;
+            for (m = 0; m < N; m++)
+            {
+                eekf_value jf = *EEKF_MAT_EL(Jf, active[i], m);
+                if (0 != jf)
+                {
+                    acc = EEKF_MAC(acc, jf, *EEKF_MAT_EL(*ctx->P, m, j));
+                }
+            }
+            *EEKF_MAT_EL(A, i, j) = EEKF_ACC_VALUE(acc);
+        }
+    }
+
+    // predict active block Pp_aa = A * Jf_a' + Q_aa
+    for (i = 0; i < nActive; i++)
+    {
+        for (l = 0; l < nActive; l++)
+        {
+            eekf_acc acc = EEKF_ACC(*EEKF_MAT_EL(*Q, active[i], active[l]));
+            for (m = 0; m < N; m++)
+            {
+                acc = EEKF_MAC(acc, *EEKF_MAT_EL(A, i, m),
+                        *EEKF_MAT_EL(Jf, active[l], m));
+            }
+            *EEKF_MAT_EL(*ctx->P, active[i], active[l]) = EEKF_ACC_VALUE(acc);
+        }
+    }
+
+    // predict cross covariance to frozen states Pp_af = A_f, Pp_fa = A_f'
+    for (i = 0; i < nActive; i++)
+    {
+        for (j = 0; j < N; j++)
+        {
+            if (!isActive[j])
+            {
+                *EEKF_MAT_EL(*ctx->P, active[i], j) = *EEKF_MAT_EL(A, i, j);
+                *EEKF_MAT_EL(*ctx->P, j, active[i]) = *EEKF_MAT_EL(A, i, j);
+            }
+        }
+    }
+
+    eekf_publish_step(ctx->publish, ctx->x, ctx->P);
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_correct_partial(eekf_context *ctx, eekf_mat const *z,
+        eekf_mat const *R, uint8_t const *active, uint8_t nActive)
+{
+    if (NULL == R || NULL == z || NULL == ctx || z->rows != R->rows
+            || z->rows != R->cols || (NULL == active && nActive > 0))
+    {
+        return eEekfReturnParameterError;
+    }
+
+    uint8_t N = ctx->x->rows;
+    uint8_t M = z->rows;
+    uint8_t isActive[N];
+    uint8_t nz[N];
+    uint8_t nNz = 0;
+    uint8_t i, j, r, c, m;
+
+    if (NULL == eekf_mark_active(isActive, N, active, nActive))
+    {
+        return eEekfReturnParameterError;
+    }
+    // everything is a consider state
+    if (0 == nActive)
+    {
+        return eEekfReturnOk;
+    }
+
+    // predicted measurement
+    EEKF_DECL_MAT_DYN(zp, M, 1);
+    // measurement linearization
+    EEKF_DECL_MAT_DYN(Jh, M, N);
+    // helper matrices
+    EEKF_DECL_MAT_DYN(PJht, N, M);
+    EEKF_DECL_MAT_DYN(L, M, M);
+    EEKF_DECL_MAT_DYN(U, M, N);
+    EEKF_DECL_MAT_DYN(Ldz, M, 1);
+
+    // predict measurement and linearize measurement: zp = h(x), Jh = dh(x)/dx
+    if (NULL != ctx->h
+            && eEekfReturnOk != ctx->h(&zp, &Jh, ctx->x, ctx->userData))
+    {
+        return eEekfReturnCallbackFailed;
+    }
+
+    // states the measurement depends on
+    for (j = 0; j < N; j++)
+    {
+        for (m = 0; m < M; m++)
+        {
+            if (0 != *EEKF_MAT_EL(Jh, m, j))
+            {
+                nz[nNz++] = j;
+                break;
+            }
+        }
+    }
+
+    // cross covariance P * Jh' over the non zero columns of Jh
+    for (m = 0; m < M; m++)
+    {
+        for (r = 0; r < N; r++)
+        {
+            eekf_acc acc = 0;
+            for (i = 0; i < nNz; i++)
+            {
+                acc = EEKF_MAC(acc, *EEKF_MAT_EL(*ctx->P, r, nz[i]),
+                        *EEKF_MAT_EL(Jh, m, nz[i]));
+            }
+            *EEKF_MAT_EL(PJht, r, m) = EEKF_ACC_VALUE(acc);
+        }
+    }
+
+    // compute cholesky factorization L of innovation covariance S = (Jh*P*Jh' + R) = L*L'
+    {
+        EEKF_DECL_MAT_DYN(S, M, M);
+        for (c = 0; c < M; c++)
+        {
+            for (r = 0; r < M; r++)
+            {
+                eekf_acc acc = EEKF_ACC(*EEKF_MAT_EL(*R, r, c));
+                for (i = 0; i < nNz; i++)
+                {
+                    acc = EEKF_MAC(acc, *EEKF_MAT_EL(Jh, r, nz[i]),
+                            *EEKF_MAT_EL(PJht, nz[i], c));
+                }
+                *EEKF_MAT_EL(S, r, c) = EEKF_ACC_VALUE(acc);
+            }
+        }
+        if (NULL == eekf_mat_chol(&L, &S))
+        {
+            return eEekfReturnComputationFailed;
+        }
+    }
+
+    // U = (L \ PJh')', Ldz = L \ (z - zp)
+    {
+        EEKF_DECL_MAT_DYN(PCtt, M, N);
+        EEKF_DECL_MAT_DYN(LPCtt, M, N);
+        EEKF_DECL_MAT_DYN(dz, M, 1);
+        if (NULL
+                == eekf_mat_trs(&U,
+                        eekf_mat_fw_sub(&LPCtt, &L, eekf_mat_trs(&PCtt, &PJht)))
+                || NULL
+                        == eekf_mat_fw_sub(&Ldz, &L, eekf_mat_sub(&dz, z, &zp)))
+        {
+            return eEekfReturnComputationFailed;
+        }
+    }
+
+    // correct active states
+    // x_a = x_a + U_a * L \ (z - zp)
+    for (i = 0; i < nActive; i++)
+    {
+        eekf_acc acc = EEKF_ACC(*EEKF_MAT_EL(*ctx->x, active[i], 0));
+        for (m = 0; m < M; m++)
+        {
+            acc = EEKF_MAC(acc, *EEKF_MAT_EL(U, active[i], m),
+                    *EEKF_MAT_EL(Ldz, m, 0));
+        }
+        *EEKF_MAT_EL(*ctx->x, active[i], 0) = EEKF_ACC_VALUE(acc);
+    }
+
+    // correct active rows and columns of covariance, keep consider block
+    // P = P - U * U'
+    for (c = 0; c < N; c++)
+    {
+        for (r = 0; r < N; r++)
+        {
+            if (!isActive[r] && !isActive[c])
+            {
+                continue;
+            }
+            eekf_acc acc = EEKF_ACC(*EEKF_MAT_EL(*ctx->P, r, c));
+            for (m = 0; m < M; m++)
+            {
+                acc = EEKF_MSC(acc, *EEKF_MAT_EL(U, r, m), *EEKF_MAT_EL(U, c, m));
+            }
+            *EEKF_MAT_EL(*ctx->P, r, c) = EEKF_ACC_VALUE(acc);
+        }
+    }
+
+    eekf_publish_step(ctx->publish, ctx->x, ctx->P);
     return eEekfReturnOk;
 }
 
 eekf_value eekf_randn()
 {
-    eekf_value x1, x2, w;
+    double x1, x2, w;
     do
     {
-        x1 = 2.0 * (eekf_value) EEKF_MAT_RAND() / EEKF_MAT_RAND_MAX - 1.0;
-        x2 = 2.0 * (eekf_value) EEKF_MAT_RAND() / EEKF_MAT_RAND_MAX - 1.0;
+        x1 = 2.0 * (double) EEKF_MAT_RAND() / EEKF_MAT_RAND_MAX - 1.0;
+        x2 = 2.0 * (double) EEKF_MAT_RAND() / EEKF_MAT_RAND_MAX - 1.0;
         w = x1 * x1 + x2 * x2;
     } while (w >= 1.0);
 
-    return x1 * EEKF_MAT_SQRT((-2.0 * EEKF_MAT_LOG(w)) / w);
+    w = x1 * EEKF_MAT_SQRT((-2.0 * EEKF_MAT_LOG(w)) / w);
+    return EEKF_VALUE(w);
+}
+
+// splitmix64 finalizer
+static uint64_t eekf_rng_mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// uniformly distributed random number in [-1, 1)
+static double eekf_rng_uniform(eekf_rng *rng)
+{
+    rng->state += 0x9e3779b97f4a7c15ULL;
+    return 2.0 * (double) (eekf_rng_mix(rng->state) >> 11)
+            / (double) (1ULL << 53) - 1.0;
+}
+
+void eekf_rng_seed(eekf_rng *rng, uint64_t seed, uint64_t stream)
+{
+    rng->state = eekf_rng_mix(seed ^ eekf_rng_mix(stream + 0x9e3779b97f4a7c15ULL));
+}
+
+eekf_value eekf_randn_r(eekf_rng *rng)
+{
+    double x1, x2, w;
+    do
+    {
+        x1 = eekf_rng_uniform(rng);
+        x2 = eekf_rng_uniform(rng);
+        w = x1 * x1 + x2 * x2;
+    } while (w >= 1.0 || w == 0.0);
+
+    w = x1 * EEKF_MAT_SQRT((-2.0 * EEKF_MAT_LOG(w)) / w);
+    return EEKF_VALUE(w);
 }
@@ -0,0 +1,278 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+
+/**
+ * Sensor fusion runtime driving a filter context from timestamped measurement queues.
+ *
+ * The queues follow the bounded queue design by Dmitry Vyukov: every slot carries a sequence
+ * number telling producers and the consumer whether the slot is free or holds a measurement.
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_fusion.c
+ * @author      Christian Meißner
+ */
+
+#include <eekf/eekf_fusion.h>
+#include <eekf/eekf_publish.h>
+
+#include <stddef.h>
+#include <string.h>
+
+eekf_return eekf_fusion_sensor_init(eekf_fusion_sensor *sensor,
+        eekf_fusion_slot *slots, eekf_value *values, uint32_t capacity,
+        uint8_t dim, ekkf_fun_h h, eekf_mat const *R, void *userData)
+{
+    if (NULL == sensor || NULL == slots || NULL == values || NULL == h
+            || NULL == R || 0 == dim || R->rows != dim || R->cols != dim
+            || 0 == capacity || 0 != (capacity & (capacity - 1)))
+    {
+        return eEekfReturnParameterError;
+    }
+
+    uint32_t i;
+
+    memset(sensor, 0, sizeof(eekf_fusion_sensor));
+    for (i = 0; i < capacity; i++)
+    {
+        slots[i].seq = i;
+        slots[i].z = values + i * dim;
+    }
+
+    sensor->slots = slots;
+    sensor->mask = capacity - 1;
+    sensor->dim = dim;
+    sensor->h = h;
+    sensor->R = R;
+    sensor->userData = userData;
+
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_fusion_push(eekf_fusion_sensor *sensor, eekf_value t,
+        eekf_value const *z)
+{
+    if (NULL == sensor || NULL == z)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    eekf_fusion_slot *slot;
+    uint32_t pos = __atomic_load_n(&sensor->head, __ATOMIC_RELAXED);
+
+    // claim a slot
+    for (;;)
+    {
+        slot = sensor->slots + (pos & sensor->mask);
+        int32_t diff = (int32_t) (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE)
+                - pos);
+
+        if (0 == diff)
+        {
+            // slot is free, try to move head
+            if (__atomic_compare_exchange_n(&sensor->head, &pos, pos + 1, 1,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // slot still holds the measurement of the previous lap: full
+            __atomic_fetch_add(&sensor->dropped, 1, __ATOMIC_RELAXED);
+            return eEekfReturnQueueFull;
+        }
+        else
+        {
+            // another producer claimed the slot
+            pos = __atomic_load_n(&sensor->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    // fill and publish the slot
+    slot->t = t;
+    memcpy(slot->z, z, sizeof(eekf_value) * sensor->dim);
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&sensor->pushed, 1, __ATOMIC_RELAXED);
+
+    return eEekfReturnOk;
+}
+
+uint32_t eekf_fusion_fill(eekf_fusion_sensor const *sensor)
+{
+    uint32_t tail = __atomic_load_n(&sensor->tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&sensor->head, __ATOMIC_RELAXED);
+
+    return head - tail;
+}
+
+void eekf_fusion_get_stats(eekf_fusion_stats *stats,
+        eekf_fusion_sensor const *sensor)
+{
+    stats->pushed = __atomic_load_n(&sensor->pushed, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&sensor->dropped, __ATOMIC_RELAXED);
+    stats->late = __atomic_load_n(&sensor->late, __ATOMIC_RELAXED);
+    stats->processed = __atomic_load_n(&sensor->processed,
+            __ATOMIC_RELAXED);
+    stats->failed = __atomic_load_n(&sensor->failed, __ATOMIC_RELAXED);
+    stats->maxFill = __atomic_load_n(&sensor->maxFill, __ATOMIC_RELAXED);
+}
+
+// increment a consumer side counter read by other threads
+static void eekf_fusion_count(uint32_t *counter)
+{
+    __atomic_store_n(counter, *counter + 1, __ATOMIC_RELAXED);
+}
+
+// get the oldest queued measurement of a sensor, NULL if the queue is empty
+static eekf_fusion_slot* eekf_fusion_peek(eekf_fusion_sensor *sensor)
+{
+    uint32_t pos = sensor->tail;
+    eekf_fusion_slot *slot = sensor->slots + (pos & sensor->mask);
+
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos + 1)
+    {
+        return NULL;
+    }
+
+    return slot;
+}
+
+// release the oldest queued measurement of a sensor to the producers
+static void eekf_fusion_pop(eekf_fusion_sensor *sensor, eekf_fusion_slot *slot)
+{
+    uint32_t pos = sensor->tail;
+    uint32_t fill = eekf_fusion_fill(sensor);
+
+    if (fill > sensor->maxFill)
+    {
+        __atomic_store_n(&sensor->maxFill, fill, __ATOMIC_RELAXED);
+    }
+
+    __atomic_store_n(&slot->seq, pos + sensor->mask + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&sensor->tail, pos + 1, __ATOMIC_RELAXED);
+}
+
+eekf_return eekf_fusion_init(eekf_fusion *fusion, eekf_context *ctx,
+        eekf_value t0, eekf_fusion_sensor *sensors, uint8_t nSensors,
+        eekf_fusion_fun_prepare prepare, eekf_mat *u, eekf_mat *Q,
+        void *userData)
+{
+    if (NULL == fusion || NULL == ctx || (NULL == sensors && nSensors > 0)
+            || NULL == prepare || NULL == u || NULL == Q)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    fusion->ctx = ctx;
+    fusion->sensors = sensors;
+    fusion->nSensors = nSensors;
+    fusion->prepare = prepare;
+    fusion->u = u;
+    fusion->Q = Q;
+    fusion->userData = userData;
+    fusion->t = t0;
+
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_fusion_run(eekf_fusion *fusion, eekf_value until)
+{
+    if (NULL == fusion)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    eekf_context *ctx = fusion->ctx;
+    eekf_return ret;
+
+    for (;;)
+    {
+        eekf_fusion_sensor *sensor = NULL;
+        eekf_fusion_slot *slot = NULL;
+        uint8_t i;
+
+        // find oldest measurement over all sensors
+        for (i = 0; i < fusion->nSensors; i++)
+        {
+            eekf_fusion_slot *s = eekf_fusion_peek(fusion->sensors + i);
+            if (NULL != s && s->t <= until && (NULL == slot || s->t < slot->t))
+            {
+                sensor = fusion->sensors + i;
+                slot = s;
+            }
+        }
+        if (NULL == slot)
+        {
+            return eEekfReturnOk;
+        }
+
+        // out of sequence measurement
+        if (slot->t < fusion->t)
+        {
+            eekf_fusion_count(&sensor->late);
+            eekf_fusion_pop(sensor, slot);
+            continue;
+        }
+
+        // predict to measurement time
+        eekf_publish_set_time(ctx->publish, slot->t);
+        if (slot->t > fusion->t)
+        {
+            if (eEekfReturnOk
+                    != (ret = fusion->prepare(fusion->u, fusion->Q,
+                            slot->t - fusion->t, fusion->userData))
+                    || eEekfReturnOk
+                            != (ret = eekf_predict(ctx, fusion->u, fusion->Q)))
+            {
+                eekf_fusion_count(&sensor->failed);
+                eekf_fusion_pop(sensor, slot);
+                return ret;
+            }
+            fusion->t = slot->t;
+        }
+
+        // correct with the measurement model of the sensor
+        {
+            ekkf_fun_h h = ctx->h;
+            void *userData = ctx->userData;
+            eekf_mat z = { slot->z, sensor->dim, 1, 0 };
+
+            ctx->h = sensor->h;
+            ctx->userData = sensor->userData;
+            ret = eekf_correct(ctx, &z, sensor->R);
+            ctx->h = h;
+            ctx->userData = userData;
+        }
+
+        if (eEekfReturnOk == ret)
+        {
+            eekf_fusion_count(&sensor->processed);
+        }
+        else
+        {
+            eekf_fusion_count(&sensor->failed);
+        }
+        eekf_fusion_pop(sensor, slot);
+    }
+}
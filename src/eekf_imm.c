@@ -0,0 +1,384 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+/**
+ * Interacting Multiple Model (IMM) filter built on model matched extended Kalman filters.
+ *
+ * @see Y. Bar-Shalom, X. R. Li, T. Kirubarajan, "Estimation with Applications to Tracking and
+ *      Navigation", section 11.6.6
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_imm.c
+ * @author      Christian Meißner
+ */
+
+#include <eekf/eekf_imm.h>
+#include <eekf/eekf_publish.h>
+
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef EEKF_FIXED
+#error "the IMM filter requires floating point, build it without EEKF_FIXED"
+#endif
+
+// compute the weighted mean x = sum(w_i * x_i) and covariance
+// P = sum(w_i * (P_i + (x_i - x) * (x_i - x)')) of the current model estimates in one pass
+static void eekf_imm_mix(eekf_mat *x, eekf_mat *P, eekf_imm const *imm,
+        eekf_value const *w)
+{
+    uint8_t N = x->rows;
+    uint8_t used[EEKF_IMM_MAX_MODELS];
+    uint8_t nUsed = 0;
+    uint8_t i, k, r, c;
+    eekf_value d[EEKF_IMM_MAX_MODELS * N];
+    eekf_value sum;
+
+    // models without weight do not contribute
+    for (i = 0; i < imm->nModels; i++)
+    {
+        if (0 != w[i])
+        {
+            used[nUsed++] = i;
+        }
+    }
+
+    // weighted mean
+    for (r = 0; r < N; r++)
+    {
+        sum = 0;
+        for (k = 0; k < nUsed; k++)
+        {
+            sum += w[used[k]] * *EEKF_MAT_EL(*imm->models[used[k]].x, r, 0);
+        }
+        *EEKF_MAT_EL(*x, r, 0) = sum;
+    }
+
+    // deviations of the model means
+    for (k = 0; k < nUsed; k++)
+    {
+        for (r = 0; r < N; r++)
+        {
+            d[k * N + r] = *EEKF_MAT_EL(*imm->models[used[k]].x, r, 0)
+                    - *EEKF_MAT_EL(*x, r, 0);
+        }
+    }
+
+    // weighted covariances and spread of the means, upper triangle mirrored
+    for (c = 0; c < N; c++)
+    {
+        for (r = 0; r <= c; r++)
+        {
+            sum = 0;
+            for (k = 0; k < nUsed; k++)
+            {
+                sum += w[used[k]] * (*EEKF_MAT_EL(*imm->models[used[k]].P, r, c)
+                        + d[k * N + r] * d[k * N + c]);
+            }
+            *EEKF_MAT_EL(*P, r, c) = sum;
+            *EEKF_MAT_EL(*P, c, r) = sum;
+        }
+    }
+}
+
+// run the model matched predictions on the estimates in buffer b, the current estimates are
+// left untouched such that a failing model does not change the IMM
+static eekf_return eekf_imm_step(eekf_imm *imm, uint8_t b,
+        eekf_mat const *u, eekf_mat const * const *Q)
+{
+    uint8_t j;
+    eekf_return ret;
+
+    for (j = 0; j < imm->nModels; j++)
+    {
+        eekf_context model = imm->models[j];
+
+        model.x = &imm->xs[b][j];
+        model.P = &imm->Ps[b][j];
+        if (NULL == Q[j])
+        {
+            return eEekfReturnParameterError;
+        }
+        if (eEekfReturnOk != (ret = eekf_predict(&model, u, Q[j])))
+        {
+            return ret;
+        }
+    }
+
+    return eEekfReturnOk;
+}
+
+// let the models point to the estimates in buffer b
+static void eekf_imm_swap(eekf_imm *imm, uint8_t b)
+{
+    uint8_t j;
+
+    for (j = 0; j < imm->nModels; j++)
+    {
+        imm->models[j].x = &imm->xs[b][j];
+        imm->models[j].P = &imm->Ps[b][j];
+    }
+    imm->buffer = b;
+}
+
+eekf_return eekf_imm_init(eekf_imm *imm, eekf_value *values, uint8_t nModels,
+        eekf_mat const *x0, eekf_mat const *P0, ekkf_fun_f const *f,
+        ekkf_fun_h h, eekf_mat const *Pi, void *userData)
+{
+    if (NULL == imm || NULL == values || 0 == nModels
+            || nModels > EEKF_IMM_MAX_MODELS || NULL == x0 || NULL == P0
+            || NULL == f || NULL == h || NULL == Pi || x0->cols != 1
+            || P0->rows != x0->rows || P0->cols != x0->rows
+            || Pi->rows != nModels || Pi->cols != nModels)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    uint8_t N = x0->rows;
+    uint16_t size = N + N * N;
+    uint8_t b, j;
+    eekf_value *v = values;
+
+    memset(imm, 0, sizeof(eekf_imm));
+
+    // combined estimate followed by the two buffers of model estimates
+    imm->x = (eekf_mat) { v, N, 1, 0 };
+    imm->P = (eekf_mat) { v + N, N, N, 0 };
+    for (b = 0; b < 2; b++)
+    {
+        for (j = 0; j < nModels; j++)
+        {
+            v += size;
+            imm->xs[b][j] = (eekf_mat) { v, N, 1, 0 };
+            imm->Ps[b][j] = (eekf_mat) { v + N, N, N, 0 };
+        }
+    }
+
+    eekf_mat_copy(&imm->x, x0);
+    eekf_mat_copy(&imm->P, P0);
+    for (j = 0; j < nModels; j++)
+    {
+        eekf_mat_copy(&imm->xs[0][j], x0);
+        eekf_mat_copy(&imm->Ps[0][j], P0);
+        if (NULL == f[j]
+                || eEekfReturnOk
+                        != eekf_init(&imm->models[j], &imm->xs[0][j],
+                                &imm->Ps[0][j], f[j], h, userData))
+        {
+            return eEekfReturnParameterError;
+        }
+        imm->mu[j] = 1. / nModels;
+    }
+
+    imm->Pi = Pi;
+    imm->nModels = nModels;
+
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_imm_set_prepare(eekf_imm *imm, eekf_imm_fun_prepare prepare,
+        void *userData)
+{
+    if (NULL == imm)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    imm->prepare = prepare;
+    imm->userData = userData;
+
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_publish_attach_imm(eekf_imm *imm, eekf_publish *pub)
+{
+    return NULL == imm ? eEekfReturnParameterError :
+            eekf_publish_attach_estimate(&imm->publish, &imm->x, &imm->P, pub);
+}
+
+eekf_return eekf_imm_predict(eekf_imm *imm, eekf_mat const *u,
+        eekf_mat const * const *Q)
+{
+    if (NULL == imm || NULL == u || NULL == Q)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    uint8_t r = imm->nModels;
+    uint8_t dst = imm->buffer ^ 1;
+    uint8_t i, j;
+    eekf_value c[EEKF_IMM_MAX_MODELS];
+    eekf_value w[EEKF_IMM_MAX_MODELS];
+    eekf_return ret;
+
+    // predicted model probabilities c_j = sum_i(Pi_ij * mu_i)
+    for (j = 0; j < r; j++)
+    {
+        c[j] = 0;
+        for (i = 0; i < r; i++)
+        {
+            c[j] += *EEKF_MAT_EL(*imm->Pi, i, j) * imm->mu[i];
+        }
+    }
+
+    // mix with weights mu_i|j = Pi_ij * mu_i / c_j into the other buffer
+    for (j = 0; j < r; j++)
+    {
+        for (i = 0; i < r; i++)
+        {
+            w[i] = c[j] > 0 ?
+                    *EEKF_MAT_EL(*imm->Pi, i, j) * imm->mu[i] / c[j] : i == j;
+        }
+        eekf_imm_mix(&imm->xs[dst][j], &imm->Ps[dst][j], imm, w);
+    }
+
+    // model matched predictions in the other buffer
+    if (eEekfReturnOk != (ret = eekf_imm_step(imm, dst, u, Q)))
+    {
+        return ret;
+    }
+
+    // all models succeeded, swap buffers
+    eekf_imm_swap(imm, dst);
+    for (j = 0; j < r; j++)
+    {
+        imm->mu[j] = c[j];
+    }
+
+    eekf_imm_mix(&imm->x, &imm->P, imm, imm->mu);
+    eekf_publish_step(imm->publish, &imm->x, &imm->P);
+
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_imm_correct(eekf_imm *imm, eekf_mat const *z,
+        eekf_mat const *R)
+{
+    if (NULL == imm || NULL == z || NULL == R || z->rows != R->rows
+            || z->rows != R->cols)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    uint8_t r = imm->nModels;
+    uint8_t N = imm->x.rows;
+    uint8_t M = z->rows;
+    uint8_t j;
+    eekf_value l[EEKF_IMM_MAX_MODELS];
+    eekf_value max = -INFINITY;
+    eekf_value sum = 0;
+    eekf_innovation inno[EEKF_IMM_MAX_MODELS];
+    eekf_return ret;
+    EEKF_DECL_MAT_DYN(zc, M, 1);
+    EEKF_DECL_MAT_DYN(Rc, M, M);
+    // linearized measurements and factorized innovation covariances of the models
+    eekf_value factors[r * (M + N * M + M * M)];
+    eekf_mat zp[EEKF_IMM_MAX_MODELS];
+    eekf_mat PJht[EEKF_IMM_MAX_MODELS];
+    eekf_mat L[EEKF_IMM_MAX_MODELS];
+    EEKF_DECL_MAT_DYN(dz, M, 1);
+    EEKF_DECL_MAT_DYN(Ldz, M, 1);
+
+    // prepare the measurement once for all models
+    if (NULL != imm->prepare)
+    {
+        eekf_mat_copy(&zc, z);
+        eekf_mat_copy(&Rc, R);
+        if (eEekfReturnOk != (ret = imm->prepare(&zc, &Rc, imm->userData)))
+        {
+            return ret;
+        }
+        z = &zc;
+        R = &Rc;
+    }
+
+    // factorize the innovations of all models before any of them is corrected, a failing model
+    // thus leaves the IMM unchanged without copying the model estimates
+    for (j = 0; j < r; j++)
+    {
+        eekf_value *v = factors + j * (M + N * M + M * M);
+
+        zp[j] = (eekf_mat) { v, M, 1, 0 };
+        PJht[j] = (eekf_mat) { v + M, N, M, 0 };
+        L[j] = (eekf_mat) { v + M + N * M, M, M, 0 };
+        if (eEekfReturnOk
+                != (ret = eekf_correct_factor(&imm->models[j], z, R, &zp[j],
+                        &PJht[j], &L[j])))
+        {
+            return ret;
+        }
+        if (NULL
+                == eekf_innovation_compute(&inno[j], &L[j],
+                        eekf_mat_fw_sub(&Ldz, &L[j],
+                                eekf_mat_sub(&dz, z, &zp[j]))))
+        {
+            return eEekfReturnComputationFailed;
+        }
+    }
+
+    // log-likelihoods
+    // log(mu_j * N(z - zp; 0, S)) = log(mu_j) - (nis + log(det(S)) + M * log(2 * pi)) / 2
+    for (j = 0; j < r; j++)
+    {
+        l[j] = EEKF_MAT_LOG(imm->mu[j])
+                - (inno[j].nis + inno[j].logDetS
+                        + z->rows * EEKF_MAT_LOG(2 * M_PI)) / 2;
+        if (l[j] > max)
+        {
+            max = l[j];
+        }
+    }
+    if (isinf(max))
+    {
+        return eEekfReturnComputationFailed;
+    }
+
+    // all models succeeded, correct them in place, this cannot fail anymore
+    for (j = 0; j < r; j++)
+    {
+        if (eEekfReturnOk
+                != (ret = eekf_correct_factored(&imm->models[j], z, &zp[j],
+                        &PJht[j], &L[j], NULL)))
+        {
+            return ret;
+        }
+    }
+
+    // normalize relative to the most likely model
+    for (j = 0; j < r; j++)
+    {
+        imm->mu[j] = exp(l[j] - max);
+        sum += imm->mu[j];
+    }
+    for (j = 0; j < r; j++)
+    {
+        imm->mu[j] /= sum;
+    }
+    imm->logLikelihood = max + EEKF_MAT_LOG(sum);
+
+    eekf_imm_mix(&imm->x, &imm->P, imm, imm->mu);
+    eekf_publish_step(imm->publish, &imm->x, &imm->P);
+
+    return eEekfReturnOk;
+}
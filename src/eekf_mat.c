@@ -36,10 +36,92 @@
 #include <string.h>
 #include <math.h>
 
+// set the dimensions of a result matrix, only matrices with contiguous columns can be reshaped
+static eekf_mat* eekf_mat_shape(eekf_mat *C, uint8_t rows, uint8_t cols)
+{
+    if (C->rows == rows && C->cols == cols)
+    {
+        return C;
+    }
+    if (EEKF_MAT_LD(*C) != C->rows || C->rows * C->cols != rows * cols)
+    {
+        return NULL;
+    }
+
+    C->rows = rows;
+    C->cols = cols;
+    if (C->ld)
+    {
+        C->ld = rows;
+    }
+
+    return C;
+}
+
+eekf_mat* eekf_mat_block(eekf_mat *V, eekf_mat const *A, uint8_t r, uint8_t c,
+        uint8_t rows, uint8_t cols)
+{
+    if (NULL == V || NULL == A || r + rows > A->rows || c + cols > A->cols)
+    {
+        return NULL;
+    }
+
+    V->elements = EEKF_MAT_EL(*A, r, c);
+    V->rows = rows;
+    V->cols = cols;
+    V->ld = EEKF_MAT_LD(*A);
+
+    return V;
+}
+
+eekf_mat* eekf_mat_rows(eekf_mat *V, eekf_mat const *A, uint8_t r, uint8_t rows)
+{
+    return NULL == A ? NULL : eekf_mat_block(V, A, r, 0, rows, A->cols);
+}
+
+eekf_mat* eekf_mat_cols(eekf_mat *V, eekf_mat const *A, uint8_t c, uint8_t cols)
+{
+    return NULL == A ? NULL : eekf_mat_block(V, A, 0, c, A->rows, cols);
+}
+
+eekf_mat* eekf_mat_diag(eekf_mat *V, eekf_mat const *A)
+{
+    if (NULL == V || NULL == A)
+    {
+        return NULL;
+    }
+
+    V->elements = A->elements;
+    V->rows = 1;
+    V->cols = A->rows < A->cols ? A->rows : A->cols;
+    // step to the next column and one row down
+    V->ld = EEKF_MAT_LD(*A) + 1;
+
+    return V;
+}
+
+eekf_mat* eekf_mat_copy(eekf_mat *B, eekf_mat const *A)
+{
+    if (NULL == B || NULL == A || NULL == eekf_mat_shape(B, A->rows, A->cols))
+    {
+        return NULL;
+    }
+
+    uint8_t c;
+
+    for (c = 0; c < A->cols; c++)
+    {
+        memmove(EEKF_MAT_COL(*B, c), EEKF_MAT_COL(*A, c),
+                sizeof(eekf_value) * A->rows);
+    }
+
+    return B;
+}
+
 eekf_mat* eekf_mat_mul(eekf_mat *C, eekf_mat const *A, eekf_mat const *B)
 {
     if ( NULL == C || NULL == A || NULL == B || A->cols != B->rows
-            || C->rows * C->cols != A->rows * B->cols)
+            || NULL == eekf_mat_shape(C, A->rows, B->cols))
     {
         return NULL;
     }
@@ -47,26 +129,25 @@ eekf_mat* eekf_mat_mul(eekf_mat *C, eekf_mat const *A, eekf_mat const *B)
     uint8_t c;
     uint8_t r;
     uint8_t i;
-    eekf_value *res;
+    uint16_t ldA = EEKF_MAT_LD(*A);
+    eekf_acc acc;
     eekf_value *value1;
     eekf_value *value2;
-
-    memset(C->elements, 0, sizeof(eekf_value) * C->rows * C->cols);
-
-    C->rows = A->rows;
-    C->cols = B->cols;
+    eekf_value *res;
 
     for (c = 0; c < C->cols; c++)
     {
-        for (r = 0; r < C->rows; r++)
+        res = EEKF_MAT_COL(*C, c);
+        for (r = 0; r < C->rows; r++, res++)
         {
-            res = C->elements + c * C->rows + r;
+            acc = 0;
             value1 = A->elements + r;
-            value2 = B->elements + c * B->rows;
-            for (i = 0; i < A->cols; i++, value1 += A->rows, value2++)
+            value2 = EEKF_MAT_COL(*B, c);
+            for (i = 0; i < A->cols; i++, value1 += ldA, value2++)
             {
-                *res += *value1 * *value2;
+                acc = EEKF_MAC(acc, *value1, *value2);
             }
+            *res = EEKF_ACC_VALUE(acc);
         }
     }
 
@@ -81,15 +162,20 @@ eekf_mat* eekf_mat_add(eekf_mat *C, eekf_mat const *A, eekf_mat const *B)
         return NULL;
     }
 
-    uint16_t N = A->rows * A->cols;
-    eekf_value *value1 = A->elements;
-    eekf_value *value2 = B->elements;
-    eekf_value *res = C->elements;
-    uint16_t i;
+    uint8_t r, c;
+    eekf_value *value1;
+    eekf_value *value2;
+    eekf_value *res;
 
-    for (i = 0; i < N; i++, value1++, value2++, res++)
+    for (c = 0; c < C->cols; c++)
     {
-        *res = *value1 + *value2;
+        value1 = EEKF_MAT_COL(*A, c);
+        value2 = EEKF_MAT_COL(*B, c);
+        res = EEKF_MAT_COL(*C, c);
+        for (r = 0; r < C->rows; r++, value1++, value2++, res++)
+        {
+            *res = EEKF_ADD(*value1, *value2);
+        }
     }
 
     return C;
@@ -103,15 +189,20 @@ eekf_mat* eekf_mat_sub(eekf_mat *C, eekf_mat const *A, eekf_mat const *B)
         return NULL;
     }
 
-    uint16_t N = A->rows * A->cols;
-    eekf_value *value1 = A->elements;
-    eekf_value *value2 = B->elements;
-    eekf_value *res = C->elements;
-    uint16_t i;
+    uint8_t r, c;
+    eekf_value *value1;
+    eekf_value *value2;
+    eekf_value *res;
 
-    for (i = 0; i < N; i++, value1++, value2++, res++)
+    for (c = 0; c < C->cols; c++)
     {
-        *res = *value1 - *value2;
+        value1 = EEKF_MAT_COL(*A, c);
+        value2 = EEKF_MAT_COL(*B, c);
+        res = EEKF_MAT_COL(*C, c);
+        for (r = 0; r < C->rows; r++, value1++, value2++, res++)
+        {
+            *res = EEKF_SUB(*value1, *value2);
+        }
     }
 
     return C;
@@ -119,23 +210,21 @@ eekf_mat* eekf_mat_sub(eekf_mat *C, eekf_mat const *A, eekf_mat const *B)
 
 eekf_mat* eekf_mat_trs(eekf_mat *At, eekf_mat const *A)
 {
-    if (NULL == At || NULL == A || A->rows * A->cols != At->cols * At->rows)
+    if (NULL == At || NULL == A || NULL == eekf_mat_shape(At, A->cols, A->rows))
     {
         return NULL;
     }
 
     uint8_t r, c;
+    uint16_t ldA = EEKF_MAT_LD(*A);
     eekf_value *res;
     eekf_value *value;
 
-    At->rows = A->cols;
-    At->cols = A->rows;
-
     for (c = 0; c < At->cols; c++)
     {
-        res = At->elements + c * At->rows;
+        res = EEKF_MAT_COL(*At, c);
         value = A->elements + c;
-        for (r = 0; r < At->rows; r++, res++, value += A->rows)
+        for (r = 0; r < At->rows; r++, res++, value += ldA)
         {
             *res = *value;
         }
@@ -146,54 +235,50 @@ eekf_mat* eekf_mat_trs(eekf_mat *At, eekf_mat const *A)
 
 eekf_mat* eekf_mat_chol(eekf_mat *L, eekf_mat const *A)
 {
-    if (NULL == L || NULL == A || A->rows * A->cols != L->rows * L->cols
-            || A->rows != A->cols)
+    if (NULL == L || NULL == A || A->rows != A->cols
+            || NULL == eekf_mat_shape(L, A->rows, A->cols))
     {
         return NULL;
     }
 
     uint16_t n, N, r, c;
-    uint16_t offset;
-    eekf_value *de, *value;
+    eekf_value *de, *value, *col;
 
     N = A->cols;
 
-    L->rows = N;
-    L->cols = N;
-
-    memset(L->elements, 0, sizeof(eekf_value) * N * N);
-    for (n = 0; n < N; n++)
+    // copy lower triangle, clear upper triangle
+    for (c = 0; c < N; c++)
     {
-        offset = n * N + n;
-        memcpy(L->elements + offset, A->elements + offset,
-                sizeof(eekf_value) * (N - n));
+        memset(EEKF_MAT_COL(*L, c), 0, sizeof(eekf_value) * c);
+        memcpy(EEKF_MAT_EL(*L, c, c), EEKF_MAT_EL(*A, c, c),
+                sizeof(eekf_value) * (N - c));
     }
 
     // @see http://www.seas.ucla.edu/~vandenbe/103/lectures/chol.pdf
     for (n = 0; n < N; n++)
     {
         // get diagonal element
-        de = L->elements + n * N + n;
+        col = EEKF_MAT_COL(*L, n);
+        de = col + n;
         // check element is positive definite
         if (*de <= 0)
         {
             return NULL;
         }
         // square root of diagonal element in place
-        *de = EEKF_MAT_SQRT(*de);
+        *de = EEKF_VALUE_SQRT(*de);
         // divide lower column elements by diagonal element
         for (r = 1; r < N - n; r++)
         {
-            *(de + r) /= *de;
+            *(de + r) = EEKF_DIV(*(de + r), *de);
         }
         // compose right submatrix
         for (c = n + 1; c < N; c++)
         {
-            value = L->elements + c * N + c;
+            value = EEKF_MAT_EL(*L, c, c);
             for (r = c; r < N; r++, value++)
             {
-                *value -= *(L->elements + n * N + r)
-                        * *(L->elements + n * N + c);
+                *value = EEKF_SUB(*value, EEKF_MUL(col[r], col[c]));
             }
         }
     }
@@ -204,18 +289,16 @@ eekf_mat* eekf_mat_chol(eekf_mat *L, eekf_mat const *A)
 eekf_mat* eekf_mat_fw_sub(eekf_mat *X, eekf_mat const *L, eekf_mat const *B)
 {
     if (NULL == X || NULL == L || NULL == B || L->rows != B->rows
-            || X->rows * X->cols != B->cols * L->cols)
+            || NULL == eekf_mat_shape(X, L->cols, B->cols))
     {
         return NULL;
     }
 
-    // set result dimensions
-    X->rows = L->cols;
-    X->cols = B->cols;
-
     // loop vars
     uint8_t i, j, k;
+    uint16_t ldL = EEKF_MAT_LD(*L);
     eekf_value *b_i, *x_i, *x_j, *diag, *row, *a_ij;
+    eekf_acc acc;
 
     // loop over cols of x and b
     for (k = 0; k < X->cols; k++)
@@ -223,19 +306,49 @@ eekf_mat* eekf_mat_fw_sub(eekf_mat *X, eekf_mat const *L, eekf_mat const *B)
         // loop over x rows
         for (i = 0, x_i = EEKF_MAT_COL(*X, k), b_i = EEKF_MAT_COL(*B, k), diag =
                 L->elements, row = L->elements; i < X->rows;
-                i++, diag += L->rows + 1, x_i++, b_i++, row++)
+                i++, diag += ldL + 1, x_i++, b_i++, row++)
         {
-            *x_i = *b_i;
+            acc = EEKF_ACC(*b_i);
             // substitute up to (excluding) current x
             for (j = 0, x_j = EEKF_MAT_COL(*X, k), a_ij = row; j < i;
-                    j++, x_j++, a_ij += L->rows)
+                    j++, x_j++, a_ij += ldL)
             {
-                *x_i -= *a_ij * *x_j;
+                acc = EEKF_MSC(acc, *a_ij, *x_j);
             }
             // divide by diagonal element of L
-            *x_i /= *diag;
+            *x_i = EEKF_DIV(EEKF_ACC_VALUE(acc), *diag);
         }
     }
     // return result
     return X;
 }
+
+#ifdef EEKF_FIXED
+uint8_t eekf_mat_headroom(eekf_mat const *A)
+{
+    uint8_t r, c;
+    uint32_t max = 0;
+    uint8_t headroom = 0;
+
+    for (c = 0; c < A->cols; c++)
+    {
+        for (r = 0; r < A->rows; r++)
+        {
+            int64_t v = *EEKF_MAT_EL(*A, r, c);
+            uint32_t m = (uint32_t) (v < 0 ? -v - 1 : v);
+            if (m > max)
+            {
+                max = m;
+            }
+        }
+    }
+
+    // count doublings until the sign bit is reached
+    while (headroom < 31 && 0 == (max & ((uint32_t) 1 << (30 - headroom))))
+    {
+        headroom++;
+    }
+
+    return headroom;
+}
+#endif
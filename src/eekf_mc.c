@@ -0,0 +1,326 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+
+/**
+ * Monte Carlo consistency harness for tuning filter noise covariances.
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_mc.c
+ * @author      Christian Meißner
+ */
+
+#include <eekf/eekf_mc.h>
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/// per thread state and statistics accumulator
+typedef struct
+{
+    eekf_mc_config const *cfg;  //!< simulation setup
+    uint32_t first;             //!< first trial of the thread
+    uint32_t stride;            //!< trial index increment of the thread
+    uint32_t trials;            //!< number of completed trials
+    uint32_t failed;            //!< number of failed trials
+    eekf_value nees;            //!< sum of NEES of completed trials
+    eekf_value nis;             //!< sum of NIS of completed trials
+    eekf_value *sqErr;          //!< sum of squared errors per state of completed trials
+} eekf_mc_worker;
+
+// draw noise w = G * n with n ~ N(0, I)
+static eekf_mat* eekf_mc_noise(eekf_mat *w, eekf_mat const *G, eekf_rng *rng)
+{
+    EEKF_DECL_MAT_DYN(n, G->cols, 1);
+    uint8_t i;
+
+    for (i = 0; i < n.rows; i++)
+    {
+        *EEKF_MAT_EL(n, i, 0) = eekf_randn_r(rng);
+    }
+
+    return eekf_mat_mul(w, G, &n);
+}
+
+// run a single trial and add its statistics to the worker on success
+static eekf_return eekf_mc_trial(eekf_mc_worker *w, uint32_t trial)
+{
+    eekf_mc_config const *cfg = w->cfg;
+    uint8_t N = cfg->x0->rows;
+    uint8_t M = cfg->R->rows;
+    uint8_t i;
+    uint32_t k;
+    eekf_return ret;
+    eekf_context ctx;
+    eekf_innovation inno;
+    eekf_rng rng;
+
+    // filter state
+    EEKF_DECL_MAT_DYN(x, N, 1);
+    EEKF_DECL_MAT_DYN(P, N, N);
+    // true state and measurement
+    EEKF_DECL_MAT_DYN(xt, N, 1);
+    EEKF_DECL_MAT_DYN(xtp, N, 1);
+    EEKF_DECL_MAT_DYN(zt, M, 1);
+    // helper matrices
+    EEKF_DECL_MAT_DYN(Jf, N, N);
+    EEKF_DECL_MAT_DYN(Jh, M, N);
+    EEKF_DECL_MAT_DYN(wx, N, 1);
+    EEKF_DECL_MAT_DYN(wz, M, 1);
+    EEKF_DECL_MAT_DYN(e, N, 1);
+    EEKF_DECL_MAT_DYN(Le, N, 1);
+    EEKF_DECL_MAT_DYN(L, N, N);
+    // trial statistics
+    eekf_value nees = 0;
+    eekf_value nis = 0;
+    eekf_value sqErr[N];
+
+    memset(sqErr, 0, sizeof(sqErr));
+    eekf_mat_copy(&x, cfg->x0);
+    eekf_mat_copy(&P, cfg->P0);
+
+    eekf_rng_seed(&rng, cfg->seed, trial);
+
+    if (eEekfReturnOk
+            != (ret = eekf_init(&ctx, &x, &P, cfg->f, cfg->h, cfg->userData)))
+    {
+        return ret;
+    }
+
+    // draw initial true state
+    if (NULL
+            == eekf_mat_add(&xt, cfg->x0,
+                    eekf_mc_noise(&wx, cfg->x0Sqrt, &rng)))
+    {
+        return eEekfReturnComputationFailed;
+    }
+
+    for (k = 0; k < cfg->steps; k++)
+    {
+        if (k > 0)
+        {
+            // propagate truth: xt = f(xt, u) + w
+            if (eEekfReturnOk
+                    != cfg->truthF(&xtp, &Jf, &xt, cfg->u, cfg->truthUserData))
+            {
+                return eEekfReturnCallbackFailed;
+            }
+            if (NULL
+                    == eekf_mat_add(&xt, &xtp,
+                            eekf_mc_noise(&wx, cfg->QtSqrt, &rng)))
+            {
+                return eEekfReturnComputationFailed;
+            }
+
+            // predict filter
+            if (eEekfReturnOk != (ret = eekf_predict(&ctx, cfg->u, cfg->Q)))
+            {
+                return ret;
+            }
+        }
+
+        // simulate measurement: zt = h(xt) + v
+        if (eEekfReturnOk != cfg->truthH(&zt, &Jh, &xt, cfg->truthUserData))
+        {
+            return eEekfReturnCallbackFailed;
+        }
+        if (NULL == eekf_mat_add(&zt, &zt, eekf_mc_noise(&wz, cfg->RtSqrt, &rng)))
+        {
+            return eEekfReturnComputationFailed;
+        }
+
+        // correct filter
+        if (eEekfReturnOk
+                != (ret = eekf_correct_innovation(&ctx, &zt, cfg->R, &inno)))
+        {
+            return ret;
+        }
+        nis += inno.nis;
+
+        // estimation error e = xt - x and nees = e' * P^-1 * e = |L \ e|^2
+        if (NULL
+                == eekf_mat_fw_sub(&Le, eekf_mat_chol(&L, &P),
+                        eekf_mat_sub(&e, &xt, &x)))
+        {
+            return eEekfReturnComputationFailed;
+        }
+        for (i = 0; i < N; i++)
+        {
+            nees += *EEKF_MAT_EL(Le, i, 0) * *EEKF_MAT_EL(Le, i, 0);
+            sqErr[i] += *EEKF_MAT_EL(e, i, 0) * *EEKF_MAT_EL(e, i, 0);
+        }
+    }
+
+    // diverged filters produce non finite statistics
+    if (!isfinite(nees) || !isfinite(nis))
+    {
+        return eEekfReturnComputationFailed;
+    }
+
+    w->nees += nees;
+    w->nis += nis;
+    for (i = 0; i < N; i++)
+    {
+        w->sqErr[i] += sqErr[i];
+    }
+
+    return eEekfReturnOk;
+}
+
+// thread entry: run every stride-th trial starting with the first one
+static void* eekf_mc_thread(void *arg)
+{
+    eekf_mc_worker *w = (eekf_mc_worker*) arg;
+    uint32_t trial;
+
+    for (trial = w->first; trial < w->cfg->trials; trial += w->stride)
+    {
+        if (eEekfReturnOk == eekf_mc_trial(w, trial))
+        {
+            w->trials++;
+        }
+        else
+        {
+            w->failed++;
+        }
+    }
+
+    return NULL;
+}
+
+eekf_return eekf_mc_run(eekf_mc_result *res, eekf_mc_config const *cfg)
+{
+    if (NULL == res || NULL == cfg || NULL == cfg->truthF
+            || NULL == cfg->truthH || NULL == cfg->f || NULL == cfg->h
+            || NULL == cfg->x0 || NULL == cfg->P0 || NULL == cfg->x0Sqrt
+            || NULL == cfg->u || NULL == cfg->Q || NULL == cfg->R
+            || NULL == cfg->QtSqrt || NULL == cfg->RtSqrt)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    uint8_t N = cfg->x0->rows;
+    uint8_t M = cfg->R->rows;
+
+    if (cfg->x0->cols != 1 || cfg->P0->rows != N || cfg->P0->cols != N
+            || cfg->x0Sqrt->rows != N || cfg->Q->rows != N
+            || cfg->Q->cols != N || cfg->R->cols != M
+            || cfg->QtSqrt->rows != N || cfg->RtSqrt->rows != M
+            || (NULL != res->rmse
+                    && (res->rmse->rows != N || res->rmse->cols != 1)))
+    {
+        return eEekfReturnParameterError;
+    }
+
+    // distribute trials over threads
+    long threads = cfg->threads;
+    if (0 == threads)
+    {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads > cfg->trials)
+    {
+        threads = cfg->trials;
+    }
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+
+    eekf_mc_worker workers[threads];
+    pthread_t ids[threads];
+    uint8_t started[threads];
+    eekf_value sqErr[threads * N];
+    long t;
+    uint8_t i;
+
+    memset(sqErr, 0, sizeof(sqErr));
+    for (t = 0; t < threads; t++)
+    {
+        memset(&workers[t], 0, sizeof(eekf_mc_worker));
+        workers[t].cfg = cfg;
+        workers[t].first = t;
+        workers[t].stride = threads;
+        workers[t].sqErr = sqErr + t * N;
+    }
+
+    // the calling thread runs the first share itself
+    for (t = 1; t < threads; t++)
+    {
+        started[t] = 0 == pthread_create(&ids[t], NULL, eekf_mc_thread,
+                        &workers[t]);
+    }
+    eekf_mc_thread(&workers[0]);
+
+    // collect results, run shares of threads which could not be started
+    memset(res, 0, offsetof(eekf_mc_result, rmse));
+    for (t = 0; t < threads; t++)
+    {
+        if (t > 0)
+        {
+            if (started[t])
+            {
+                pthread_join(ids[t], NULL);
+            }
+            else
+            {
+                eekf_mc_thread(&workers[t]);
+            }
+        }
+
+        res->trials += workers[t].trials;
+        res->failed += workers[t].failed;
+        res->nees += workers[t].nees;
+        res->nis += workers[t].nis;
+        if (t > 0)
+        {
+            for (i = 0; i < N; i++)
+            {
+                sqErr[i] += workers[t].sqErr[i];
+            }
+        }
+    }
+
+    if (0 == res->trials || 0 == cfg->steps)
+    {
+        return eEekfReturnComputationFailed;
+    }
+
+    // average over all steps of all completed trials
+    eekf_value samples = (eekf_value) res->trials * cfg->steps;
+    res->nees /= samples;
+    res->nis /= samples;
+    if (NULL != res->rmse)
+    {
+        for (i = 0; i < N; i++)
+        {
+            *EEKF_MAT_EL(*res->rmse, i, 0) = EEKF_MAT_SQRT(sqErr[i] / samples);
+        }
+    }
+
+    return eEekfReturnOk;
+}
@@ -0,0 +1,201 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+/**
+ * Published estimate for lock-free concurrent reads of the filter state.
+ *
+ * The seqlock follows H.-J. Boehm, "Can seqlocks get along with programming language memory
+ * models?": the writer marks a copy as being written by an odd sequence number, the readers
+ * validate their copy by reading the same even sequence number before and after it.
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_publish.c
+ * @author      Christian Meißner
+ */
+
+#include <eekf/eekf_publish.h>
+
+#include <stddef.h>
+#include <string.h>
+
+eekf_return eekf_publish_init(eekf_publish *pub, eekf_value *values,
+        uint8_t states)
+{
+    if (NULL == pub || NULL == values || 0 == states)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    uint8_t i;
+    uint16_t size = states + states * states;
+
+    memset(pub, 0, sizeof(eekf_publish));
+    memset(values, 0, sizeof(eekf_value) * 2 * size);
+    for (i = 0; i < 2; i++)
+    {
+        pub->slots[i].x = values + i * size;
+        pub->slots[i].P = values + i * size + states;
+    }
+    pub->states = states;
+
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_publish_attach_estimate(struct eekf_publish **publish,
+        eekf_mat const *x, eekf_mat const *P, eekf_publish *pub)
+{
+    if (NULL == publish || NULL == x || NULL == P
+            || (NULL != pub && x->rows != pub->states))
+    {
+        return eEekfReturnParameterError;
+    }
+
+    *publish = pub;
+    if (NULL == pub)
+    {
+        return eEekfReturnOk;
+    }
+
+    // publish the estimate right away
+    pub->step = 0;
+    return eekf_publish_write(pub, x, P);
+}
+
+eekf_return eekf_publish_attach(eekf_context *ctx, eekf_publish *pub)
+{
+    return NULL == ctx ? eEekfReturnParameterError :
+            eekf_publish_attach_estimate(&ctx->publish, ctx->x, ctx->P, pub);
+}
+
+void eekf_publish_set_time(eekf_publish *pub, eekf_value t)
+{
+    if (NULL != pub)
+    {
+        pub->t = t;
+    }
+}
+
+void eekf_publish_step(eekf_publish *pub, eekf_mat const *x, eekf_mat const *P)
+{
+    if (NULL != pub && eEekfReturnOk != eekf_publish_write(pub, x, P))
+    {
+        pub->failed++;
+    }
+}
+
+eekf_return eekf_publish_write(eekf_publish *pub, eekf_mat const *x,
+        eekf_mat const *P)
+{
+    if (NULL == pub || NULL == x || NULL == P || x->rows != pub->states
+            || x->cols != 1 || P->rows != pub->states
+            || P->cols != pub->states)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    // write to the copy readers are not directed to
+    uint32_t i = __atomic_load_n(&pub->latest, __ATOMIC_RELAXED) ^ 1;
+    eekf_publish_slot *slot = pub->slots + i;
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+    uint8_t c;
+
+    // mark the copy as being written before any of its data changes
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->step = pub->step++;
+    slot->t = pub->t;
+    memcpy(slot->x, x->elements, sizeof(eekf_value) * pub->states);
+    for (c = 0; c < pub->states; c++)
+    {
+        memcpy(slot->P + c * pub->states, EEKF_MAT_COL(*P, c),
+                sizeof(eekf_value) * pub->states);
+    }
+
+    // mark the copy as complete and direct readers to it
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&pub->latest, i, __ATOMIC_RELEASE);
+
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_publish_read(eekf_publish const *pub, eekf_mat *x,
+        eekf_mat *P, eekf_value *t, uint32_t *step)
+{
+    if (NULL == pub
+            || (NULL != x && (x->rows != pub->states || x->cols != 1))
+            || (NULL != P && (P->rows != pub->states || P->cols != pub->states)))
+    {
+        return eEekfReturnParameterError;
+    }
+
+    eekf_publish_slot const *slot;
+    uint32_t seq;
+    uint32_t s;
+    eekf_value ts;
+    uint8_t c;
+
+    for (;;)
+    {
+        slot = pub->slots + __atomic_load_n(&pub->latest, __ATOMIC_ACQUIRE);
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        // the writer lapped the reader and is writing this copy again
+        if (seq & 1)
+        {
+            continue;
+        }
+
+        s = slot->step;
+        ts = slot->t;
+        if (NULL != x)
+        {
+            memcpy(x->elements, slot->x, sizeof(eekf_value) * pub->states);
+        }
+        if (NULL != P)
+        {
+            for (c = 0; c < pub->states; c++)
+            {
+                memcpy(EEKF_MAT_COL(*P, c), slot->P + c * pub->states,
+                        sizeof(eekf_value) * pub->states);
+            }
+        }
+
+        // the copy is consistent if it was not written in the meantime
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (seq == __atomic_load_n(&slot->seq, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+    }
+
+    if (NULL != t)
+    {
+        *t = ts;
+    }
+    if (NULL != step)
+    {
+        *step = s;
+    }
+
+    return eEekfReturnOk;
+}
@@ -0,0 +1,332 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+
+/**
+ * Functions to compute filter states of a derivative-free sigma-point filter.
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_sp.c
+ * @author      Christian Meißner
+ */
+
+#include <eekf/eekf_sp.h>
+#include <eekf/eekf_publish.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef EEKF_FIXED
+#error "the sigma-point filter requires floating point, build it without EEKF_FIXED"
+#endif
+
+/// weights of the scaled unscented transformation
+typedef struct
+{
+    eekf_value m0;      //!< mean weight of the center point
+    eekf_value c0;      //!< covariance weight of the center point
+    eekf_value i;       //!< mean and covariance weight of the other points
+    eekf_value spread;  //!< sigma-point distance factor sqrt(N + lambda)
+} eekf_sp_weights;
+
+// compute the weights for N states, fails if N + lambda <= 0
+static eekf_sp_weights* eekf_sp_weights_compute(eekf_sp_weights *w,
+        eekf_sp_context const *ctx, uint8_t N)
+{
+    eekf_value c = ctx->alpha * ctx->alpha * (N + ctx->kappa);
+
+    if (c <= 0)
+    {
+        return NULL;
+    }
+
+    w->m0 = (c - N) / c;
+    w->c0 = w->m0 + 1 - ctx->alpha * ctx->alpha + ctx->beta;
+    w->i = 1 / (2 * c);
+    w->spread = EEKF_MAT_SQRT(c);
+
+    return w;
+}
+
+// generate sigma points X = [x, x + spread * L, x - spread * L] with P = L * L'
+static eekf_mat* eekf_sp_points(eekf_mat *X, eekf_mat const *x,
+        eekf_mat const *P, eekf_sp_weights const *w)
+{
+    uint8_t N = x->rows;
+    uint8_t r, c;
+    EEKF_DECL_MAT_DYN(L, N, N);
+
+    if (NULL == eekf_mat_chol(&L, P))
+    {
+        return NULL;
+    }
+
+    for (r = 0; r < N; r++)
+    {
+        *EEKF_MAT_EL(*X, r, 0) = *EEKF_MAT_EL(*x, r, 0);
+    }
+    for (c = 0; c < N; c++)
+    {
+        for (r = 0; r < N; r++)
+        {
+            eekf_value d = w->spread * *EEKF_MAT_EL(L, r, c);
+            *EEKF_MAT_EL(*X, r, 1 + c) = *EEKF_MAT_EL(*x, r, 0) + d;
+            *EEKF_MAT_EL(*X, r, 1 + N + c) = *EEKF_MAT_EL(*x, r, 0) - d;
+        }
+    }
+
+    return X;
+}
+
+// compute weighted mean m of points Y, deviations D = Y - m and weighted deviations
+// DW = D * diag(Wc) (DW may be NULL)
+static void eekf_sp_moments(eekf_mat *m, eekf_mat *D, eekf_mat *DW,
+        eekf_mat const *Y, eekf_sp_weights const *w)
+{
+    uint8_t r, c;
+
+    for (r = 0; r < Y->rows; r++)
+    {
+        eekf_value sum = 0;
+        for (c = 1; c < Y->cols; c++)
+        {
+            sum += *EEKF_MAT_EL(*Y, r, c);
+        }
+        *EEKF_MAT_EL(*m, r, 0) = w->m0 * *EEKF_MAT_EL(*Y, r, 0) + w->i * sum;
+    }
+
+    for (c = 0; c < Y->cols; c++)
+    {
+        eekf_value wc = 0 == c ? w->c0 : w->i;
+        for (r = 0; r < Y->rows; r++)
+        {
+            *EEKF_MAT_EL(*D, r, c) = *EEKF_MAT_EL(*Y, r, c)
+                    - *EEKF_MAT_EL(*m, r, 0);
+            if (NULL != DW)
+            {
+                *EEKF_MAT_EL(*DW, r, c) = wc * *EEKF_MAT_EL(*D, r, c);
+            }
+        }
+    }
+}
+
+eekf_return eekf_sp_init(eekf_sp_context *ctx, eekf_mat *x, eekf_mat *P,
+        eekf_sp_fun_f f, eekf_sp_fun_h h, void *userData)
+{
+    if (NULL == ctx || NULL == x || NULL == P || NULL == f || NULL == h
+            || x->rows != P->rows || x->rows != P->cols || x->rows > 127)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    // state
+    ctx->x = x;
+    ctx->P = P;
+
+    // callbacks
+    ctx->f = f;
+    ctx->h = h;
+
+    // user defined data
+    ctx->userData = userData;
+
+    // no published estimate
+    ctx->publish = NULL;
+
+    // cubature rule
+    ctx->alpha = 1;
+    ctx->beta = 0;
+    ctx->kappa = 0;
+
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_sp_set_params(eekf_sp_context *ctx, eekf_value alpha,
+        eekf_value beta, eekf_value kappa)
+{
+    eekf_sp_context tmp;
+    eekf_sp_weights w;
+
+    if (NULL == ctx)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    // validate the parameters before applying them
+    tmp.alpha = alpha;
+    tmp.beta = beta;
+    tmp.kappa = kappa;
+    if (NULL == eekf_sp_weights_compute(&w, &tmp, ctx->x->rows))
+    {
+        return eEekfReturnParameterError;
+    }
+
+    ctx->alpha = alpha;
+    ctx->beta = beta;
+    ctx->kappa = kappa;
+
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_publish_attach_sp(eekf_sp_context *ctx, eekf_publish *pub)
+{
+    return NULL == ctx ? eEekfReturnParameterError :
+            eekf_publish_attach_estimate(&ctx->publish, ctx->x, ctx->P, pub);
+}
+
+eekf_return eekf_sp_predict(eekf_sp_context *ctx, eekf_mat const *u,
+        eekf_mat const *Q)
+{
+    if (NULL == Q || NULL == u || NULL == ctx)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    eekf_sp_weights w;
+    uint8_t N = ctx->x->rows;
+
+    if (NULL == eekf_sp_weights_compute(&w, ctx, N))
+    {
+        return eEekfReturnParameterError;
+    }
+
+    // sigma points and their predictions
+    EEKF_DECL_MAT_DYN(X, N, 2 * N + 1);
+    EEKF_DECL_MAT_DYN(Xp, N, 2 * N + 1);
+    // helper matrices
+    EEKF_DECL_MAT_DYN(D, N, 2 * N + 1);
+    EEKF_DECL_MAT_DYN(DW, N, 2 * N + 1);
+    EEKF_DECL_MAT_DYN(Dt, 2 * N + 1, N);
+
+    if (NULL == eekf_sp_points(&X, ctx->x, ctx->P, &w))
+    {
+        return eEekfReturnComputationFailed;
+    }
+
+    // predict all sigma points at once: Xp = f(X,u)
+    if (NULL != ctx->f
+            && eEekfReturnOk != ctx->f(&Xp, &X, u, ctx->userData))
+    {
+        return eEekfReturnCallbackFailed;
+    }
+
+    // predict state x = Xp * Wm
+    eekf_sp_moments(ctx->x, &D, &DW, &Xp, &w);
+
+    // predict covariance Pp = D * diag(Wc) * D' + Q
+    if (NULL
+            == eekf_mat_add(ctx->P,
+                    eekf_mat_mul(ctx->P, &DW, eekf_mat_trs(&Dt, &D)), Q))
+    {
+        return eEekfReturnComputationFailed;
+    }
+
+    eekf_publish_step(ctx->publish, ctx->x, ctx->P);
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_sp_correct(eekf_sp_context *ctx, eekf_mat const *z,
+        eekf_mat const *R)
+{
+    return eekf_sp_correct_innovation(ctx, z, R, NULL);
+}
+
+eekf_return eekf_sp_correct_innovation(eekf_sp_context *ctx, eekf_mat const *z,
+        eekf_mat const *R, eekf_innovation *inno)
+{
+    if (NULL == R || NULL == z || NULL == ctx || z->rows != R->rows
+            || z->rows != R->cols)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    eekf_sp_weights w;
+    uint8_t N = ctx->x->rows;
+    uint8_t M = z->rows;
+
+    if (NULL == eekf_sp_weights_compute(&w, ctx, N))
+    {
+        return eEekfReturnParameterError;
+    }
+
+    // sigma points and their measurement predictions
+    EEKF_DECL_MAT_DYN(X, N, 2 * N + 1);
+    EEKF_DECL_MAT_DYN(Z, M, 2 * N + 1);
+    // predicted measurement
+    EEKF_DECL_MAT_DYN(zp, M, 1);
+    // helper matrices
+    EEKF_DECL_MAT_DYN(Dx, N, 2 * N + 1);
+    EEKF_DECL_MAT_DYN(Dz, M, 2 * N + 1);
+    EEKF_DECL_MAT_DYN(DzWt, 2 * N + 1, M);
+    EEKF_DECL_MAT_DYN(C, N, M);
+    EEKF_DECL_MAT_DYN(L, M, M);
+
+    if (NULL == eekf_sp_points(&X, ctx->x, ctx->P, &w))
+    {
+        return eEekfReturnComputationFailed;
+    }
+
+    // predict measurements of all sigma points at once: Z = h(X)
+    if (NULL != ctx->h && eEekfReturnOk != ctx->h(&Z, &X, ctx->userData))
+    {
+        return eEekfReturnCallbackFailed;
+    }
+
+    // state and measurement deviations
+    {
+        EEKF_DECL_MAT_DYN(xm, N, 1);
+        EEKF_DECL_MAT_DYN(DzW, M, 2 * N + 1);
+
+        eekf_sp_moments(&xm, &Dx, NULL, &X, &w);
+        eekf_sp_moments(&zp, &Dz, &DzW, &Z, &w);
+
+        if (NULL == eekf_mat_trs(&DzWt, &DzW))
+        {
+            return eEekfReturnComputationFailed;
+        }
+    }
+
+    // cross covariance C = Dx * diag(Wc) * Dz'
+    if (NULL == eekf_mat_mul(&C, &Dx, &DzWt))
+    {
+        return eEekfReturnComputationFailed;
+    }
+
+    // compute cholesky factorization L of innovation covariance
+    // S = (Dz * diag(Wc) * Dz' + R) = L*L'
+    {
+        EEKF_DECL_MAT_DYN(S, M, M);
+        if (NULL == eekf_mat_chol(&L, eekf_mat_add( // innovation covariance
+                &S, eekf_mat_mul(&S, &Dz, &DzWt), R)))
+        {
+            return eEekfReturnComputationFailed;
+        }
+    }
+
+    // the remaining correction is the one of the extended Kalman filter with C in place of P * Jh'
+    eekf_context ekf = { ctx->x, ctx->P, NULL, NULL, ctx->userData,
+            ctx->publish };
+
+    return eekf_correct_factored(&ekf, z, &zp, &C, &L, inno);
+}
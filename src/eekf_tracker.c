@@ -0,0 +1,681 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+/**
+ * Multi-target tracker running one extended Kalman filter per track.
+ *
+ * @see D. P. Bertsekas, "The auction algorithm: A distributed relaxation method for the
+ *      assignment problem", Annals of Operations Research 14, 1988
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_tracker.c
+ * @author      Christian Meißner
+ */
+
+#include <eekf/eekf_tracker.h>
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef EEKF_FIXED
+#error "the multi-target tracker requires floating point, build it without EEKF_FIXED"
+#endif
+
+// point the matrices and the filter context of a track to its values
+static void eekf_tracker_bind(eekf_tracker *tr, uint32_t i)
+{
+    uint8_t N = tr->cfg.states;
+    uint8_t M = tr->cfg.dim;
+    uint32_t size = EEKF_TRACKER_TRACK_SIZE(N, M);
+    eekf_tracker_track *t = tr->tracks + i;
+    eekf_value *v = tr->values + (size_t) i * size;
+
+    t->x = (eekf_mat) { v, N, 1, 0 };
+    t->P = (eekf_mat) { v + N, N, N, 0 };
+    t->zp = (eekf_mat) { v + N + N * N, M, 1, 0 };
+    t->PJht = (eekf_mat) { v + N + N * N + M, N, M, 0 };
+    t->L = (eekf_mat) { v + N + N * N + M + N * M, M, M, 0 };
+    t->ctx.x = &t->x;
+    t->ctx.P = &t->P;
+}
+
+// grid cell of a coordinate, clamped to the representable range
+static int64_t eekf_tracker_cell(eekf_value v, eekf_value cellSize)
+{
+    eekf_value c = floor(v / cellSize);
+
+    // also catches NaN
+    if (!(c > -4e18))
+    {
+        return (int64_t) -4e18;
+    }
+    return c < 4e18 ? (int64_t) c : (int64_t) 4e18;
+}
+
+// hash bucket of a grid cell
+static uint32_t eekf_tracker_hash(int64_t c0, int64_t c1, uint32_t nBuckets)
+{
+    uint64_t h = (uint64_t) c0 * 0x9E3779B97F4A7C15ull
+            ^ (uint64_t) c1 * 0xC2B2AE3D27D4EB4Full;
+
+    return (uint32_t) (h >> 32) & (nBuckets - 1);
+}
+
+// sort the measurements of a scan into the hash buckets of their grid cells
+static void eekf_tracker_grid(eekf_tracker *tr, eekf_value const *Z,
+        uint32_t nMeas)
+{
+    uint8_t const *axes = tr->cfg.axes;
+    uint8_t M = tr->cfg.dim;
+    uint32_t b, j;
+
+    memset(tr->buckets, 0, sizeof(uint32_t) * (tr->nBuckets + 1));
+    for (j = 0; j < nMeas; j++)
+    {
+        eekf_tracker_meas *m = tr->meas + j;
+        m->cell[0] = eekf_tracker_cell(Z[j * M + axes[0]], tr->cfg.cellSize);
+        // a one dimensional grid keeps the second cell coordinate at 0
+        m->cell[1] = axes[0] == axes[1] ? 0 : eekf_tracker_cell(
+                Z[j * M + axes[1]], tr->cfg.cellSize);
+        m->bucket = eekf_tracker_hash(m->cell[0], m->cell[1], tr->nBuckets);
+        m->owner = -1;
+        m->price = 0;
+        tr->buckets[m->bucket + 1]++;
+    }
+
+    // counting sort: bucket starts, fill advancing the starts, shift them back
+    for (b = 0; b < tr->nBuckets; b++)
+    {
+        tr->buckets[b + 1] += tr->buckets[b];
+    }
+    for (j = 0; j < nMeas; j++)
+    {
+        tr->meas[tr->buckets[tr->meas[j].bucket]++].sorted = j;
+    }
+    for (b = tr->nBuckets; b > 0; b--)
+    {
+        tr->buckets[b] = tr->buckets[b - 1];
+    }
+    tr->buckets[0] = 0;
+}
+
+// compute the gating distances of a batch of candidate measurements and keep the closest ones
+static void eekf_tracker_batch(eekf_tracker_worker *w, eekf_tracker_track *t,
+        uint32_t const *batch, uint8_t n)
+{
+    uint8_t M = w->tr->cfg.dim;
+    uint8_t r, c, k;
+    EEKF_DECL_MAT_DYN(D, M, n);
+    EEKF_DECL_MAT_DYN(Y, M, n);
+
+    // all squared Mahalanobis distances |L \ (z - zp)|^2 with one forward substitution
+    for (c = 0; c < n; c++)
+    {
+        for (r = 0; r < M; r++)
+        {
+            *EEKF_MAT_EL(D, r, c) = w->Z[batch[c] * M + r]
+                    - *EEKF_MAT_EL(t->zp, r, 0);
+        }
+    }
+    eekf_mat_fw_sub(&Y, &t->L, &D);
+    w->stats.candidates += n;
+
+    for (c = 0; c < n; c++)
+    {
+        eekf_value d2 = 0;
+        for (r = 0; r < M; r++)
+        {
+            d2 += *EEKF_MAT_EL(Y, r, c) * *EEKF_MAT_EL(Y, r, c);
+        }
+        if (d2 > w->tr->cfg.gamma)
+        {
+            continue;
+        }
+
+        // insert into the kept measurements ordered by distance
+        t->gated++;
+        if (EEKF_TRACKER_MAX_GATED == t->nGated)
+        {
+            if (d2 >= t->gatedCost[EEKF_TRACKER_MAX_GATED - 1])
+            {
+                continue;
+            }
+            t->nGated--;
+        }
+        for (k = t->nGated; k > 0 && t->gatedCost[k - 1] > d2; k--)
+        {
+            t->gatedMeas[k] = t->gatedMeas[k - 1];
+            t->gatedCost[k] = t->gatedCost[k - 1];
+        }
+        t->gatedMeas[k] = batch[c];
+        t->gatedCost[k] = d2;
+        t->nGated++;
+    }
+}
+
+// predict a track and gate the measurements of the scan against it
+static eekf_return eekf_tracker_gate(eekf_tracker_worker *w,
+        eekf_tracker_track *t)
+{
+    eekf_tracker *tr = w->tr;
+    uint8_t N = tr->cfg.states;
+    uint8_t M = tr->cfg.dim;
+    uint8_t const *axes = tr->cfg.axes;
+    uint32_t batch[EEKF_TRACKER_BATCH];
+    uint8_t n = 0;
+    int64_t lo[2], hi[2], c0, c1;
+    uint32_t j, k;
+    uint8_t a;
+    eekf_return ret;
+    EEKF_DECL_MAT_DYN(Jh, M, N);
+    EEKF_DECL_MAT_DYN(Jht, N, M);
+    EEKF_DECL_MAT_DYN(S, M, M);
+
+    if (eEekfReturnOk != (ret = eekf_predict(&t->ctx, w->u, w->Q)))
+    {
+        return ret;
+    }
+    if (eEekfReturnOk != tr->cfg.h(&t->zp, &Jh, &t->x, tr->cfg.userData))
+    {
+        return eEekfReturnCallbackFailed;
+    }
+
+    // innovation covariance S = Jh * P * Jh' + R = L * L', kept for the correction
+    if (NULL == eekf_mat_mul(&t->PJht, &t->P, eekf_mat_trs(&Jht, &Jh))
+            || NULL == eekf_mat_chol(&t->L,
+                    eekf_mat_add(&S, eekf_mat_mul(&S, &Jh, &t->PJht), w->R)))
+    {
+        return eEekfReturnComputationFailed;
+    }
+
+    // cells overlapped by the bounding box of the gate, half width sqrt(gamma * S_aa) on axis a
+    for (a = 0; a < 2; a++)
+    {
+        eekf_value zp = *EEKF_MAT_EL(t->zp, axes[a], 0);
+        eekf_value hw = sqrt(tr->cfg.gamma * *EEKF_MAT_EL(S, axes[a], axes[a]));
+        lo[a] = eekf_tracker_cell(zp - hw, tr->cfg.cellSize);
+        hi[a] = eekf_tracker_cell(zp + hw, tr->cfg.cellSize);
+    }
+    if (axes[0] == axes[1])
+    {
+        lo[1] = 0;
+        hi[1] = 0;
+    }
+
+    if ((double) (hi[0] - lo[0] + 1) * (hi[1] - lo[1] + 1) > w->nMeas)
+    {
+        // gate spans more cells than there are measurements
+        for (j = 0; j < w->nMeas; j++)
+        {
+            batch[n++] = j;
+            if (EEKF_TRACKER_BATCH == n)
+            {
+                eekf_tracker_batch(w, t, batch, n);
+                n = 0;
+            }
+        }
+    }
+    else
+    {
+        for (c0 = lo[0]; c0 <= hi[0]; c0++)
+        {
+            for (c1 = lo[1]; c1 <= hi[1]; c1++)
+            {
+                uint32_t b = eekf_tracker_hash(c0, c1, tr->nBuckets);
+                for (k = tr->buckets[b]; k < tr->buckets[b + 1]; k++)
+                {
+                    eekf_tracker_meas const *m = tr->meas + tr->meas[k].sorted;
+                    // skip measurements of other cells sharing the bucket
+                    if (m->cell[0] != c0 || m->cell[1] != c1)
+                    {
+                        continue;
+                    }
+                    batch[n++] = tr->meas[k].sorted;
+                    if (EEKF_TRACKER_BATCH == n)
+                    {
+                        eekf_tracker_batch(w, t, batch, n);
+                        n = 0;
+                    }
+                }
+            }
+        }
+    }
+    if (n > 0)
+    {
+        eekf_tracker_batch(w, t, batch, n);
+    }
+
+    return eEekfReturnOk;
+}
+
+// correct a track with its assigned measurement reusing the factorization of the gating
+static eekf_return eekf_tracker_correct(eekf_tracker_worker *w,
+        eekf_tracker_track *t)
+{
+    uint8_t M = w->tr->cfg.dim;
+    EEKF_DECL_MAT_DYN(z, M, 1);
+
+    memcpy(z.elements, w->Z + (size_t) t->meas * M, sizeof(eekf_value) * M);
+    return eekf_correct_factored(&t->ctx, &z, &t->zp, &t->PJht, &t->L, NULL);
+}
+
+// process every stride-th track starting with the first one
+static void eekf_tracker_share(eekf_tracker_worker *w)
+{
+    uint32_t i;
+
+    for (i = w->first; i < w->tr->nTracks; i += w->stride)
+    {
+        eekf_tracker_track *t = w->tr->tracks + i;
+
+        if (!w->correct)
+        {
+            t->meas = -1;
+            t->gated = 0;
+            t->nGated = 0;
+            t->status = eekf_tracker_gate(w, t);
+            w->stats.gated += t->gated;
+            w->stats.truncated += t->gated - t->nGated;
+        }
+        else if (eEekfReturnOk != t->status)
+        {
+            w->stats.failed++;
+        }
+        else if (t->meas < 0)
+        {
+            t->misses++;
+            w->stats.missed++;
+        }
+        else if (eEekfReturnOk != (t->status = eekf_tracker_correct(w, t)))
+        {
+            w->stats.failed++;
+        }
+        else
+        {
+            t->hits++;
+            t->misses = 0;
+            w->stats.assigned++;
+        }
+    }
+}
+
+// thread entry: run the share of the worker in every dispatched phase until stopped
+static void* eekf_tracker_thread(void *arg)
+{
+    eekf_tracker_worker *w = (eekf_tracker_worker*) arg;
+    eekf_tracker_pool *pool = &w->tr->pool;
+    uint32_t phase = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;)
+    {
+        while (phase == pool->phase && !pool->stop)
+        {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->stop)
+        {
+            break;
+        }
+        phase = pool->phase;
+        pthread_mutex_unlock(&pool->lock);
+
+        eekf_tracker_share(w);
+
+        pthread_mutex_lock(&pool->lock);
+        if (0 == --pool->pending)
+        {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+// run a phase of the scan on all workers
+static void eekf_tracker_dispatch(eekf_tracker *tr, uint8_t correct)
+{
+    eekf_tracker_pool *pool = &tr->pool;
+    uint8_t t;
+
+    for (t = 0; t < pool->nWorkers; t++)
+    {
+        pool->workers[t].correct = correct;
+    }
+
+    // wake the threads, the scan data is handed over by the lock
+    if (pool->nStarted > 0)
+    {
+        pthread_mutex_lock(&pool->lock);
+        pool->pending = pool->nStarted;
+        pool->phase++;
+        pthread_cond_broadcast(&pool->start);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    // the calling thread runs the first share and those of threads which could not be started
+    for (t = 0; t < pool->nWorkers; t++)
+    {
+        if (!pool->workers[t].started)
+        {
+            eekf_tracker_share(&pool->workers[t]);
+        }
+    }
+
+    if (pool->nStarted > 0)
+    {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->pending > 0)
+        {
+            pthread_cond_wait(&pool->done, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+// solve the assignment of the gated measurements to the tracks with the auction algorithm,
+// every track may stay unassigned at the cost of the gate threshold
+static void eekf_tracker_auction(eekf_tracker *tr)
+{
+    int32_t head = -1;
+    uint32_t i;
+    uint8_t k;
+
+    // queue all tracks with gated measurements
+    for (i = 0; i < tr->nTracks; i++)
+    {
+        if (eEekfReturnOk == tr->tracks[i].status && tr->tracks[i].nGated > 0)
+        {
+            tr->tracks[i].next = head;
+            head = i;
+        }
+    }
+
+    while (head >= 0)
+    {
+        eekf_tracker_track *t = tr->tracks + head;
+        int32_t bidder = head;
+        int32_t best = -1;
+        // staying unassigned has the value 0
+        eekf_value v1 = 0;
+        eekf_value v2 = -INFINITY;
+
+        head = t->next;
+
+        // best and second best value of gamma - d2 - price
+        for (k = 0; k < t->nGated; k++)
+        {
+            eekf_value v = tr->cfg.gamma - t->gatedCost[k]
+                    - tr->meas[t->gatedMeas[k]].price;
+            if (v > v1)
+            {
+                v2 = v1;
+                v1 = v;
+                best = t->gatedMeas[k];
+            }
+            else if (v > v2)
+            {
+                v2 = v;
+            }
+        }
+        if (best < 0)
+        {
+            continue;
+        }
+
+        // bid, the outbid track queues again
+        eekf_tracker_meas *m = tr->meas + best;
+        m->price += v1 - v2 + tr->cfg.epsilon;
+        if (m->owner >= 0)
+        {
+            tr->tracks[m->owner].meas = -1;
+            tr->tracks[m->owner].next = head;
+            head = m->owner;
+        }
+        m->owner = bidder;
+        t->meas = best;
+        tr->stats.bids++;
+    }
+}
+
+eekf_return eekf_tracker_init(eekf_tracker *tr, eekf_tracker_config const *cfg,
+        eekf_tracker_track *tracks, eekf_value *values, uint32_t maxTracks,
+        eekf_tracker_meas *meas, uint32_t maxMeas, uint32_t *buckets,
+        uint32_t nBuckets)
+{
+    if (NULL == tr || NULL == cfg || NULL == tracks || NULL == values
+            || NULL == meas || NULL == buckets || NULL == cfg->f
+            || NULL == cfg->h || 0 == cfg->states || 0 == cfg->dim
+            || cfg->axes[0] >= cfg->dim || cfg->axes[1] >= cfg->dim
+            || !(cfg->cellSize > 0) || !(cfg->gamma > 0)
+            || !(cfg->epsilon > 0) || 0 == nBuckets
+            || 0 != (nBuckets & (nBuckets - 1)))
+    {
+        return eEekfReturnParameterError;
+    }
+
+    memset(tr, 0, sizeof(eekf_tracker));
+    tr->cfg = *cfg;
+    tr->tracks = tracks;
+    tr->values = values;
+    tr->maxTracks = maxTracks;
+    tr->meas = meas;
+    tr->maxMeas = maxMeas;
+    tr->buckets = buckets;
+    tr->nBuckets = nBuckets;
+
+    // distribute tracks over workers
+    eekf_tracker_pool *pool = &tr->pool;
+    long threads = cfg->threads;
+    uint8_t t;
+
+    if (0 == threads)
+    {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads > EEKF_TRACKER_MAX_THREADS)
+    {
+        threads = EEKF_TRACKER_MAX_THREADS;
+    }
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+    pool->nWorkers = (uint8_t) threads;
+    if (0 != pthread_mutex_init(&pool->lock, NULL)
+            || 0 != pthread_cond_init(&pool->start, NULL)
+            || 0 != pthread_cond_init(&pool->done, NULL))
+    {
+        return eEekfReturnComputationFailed;
+    }
+
+    // the first worker is the calling thread
+    for (t = 0; t < pool->nWorkers; t++)
+    {
+        eekf_tracker_worker *w = pool->workers + t;
+        w->tr = tr;
+        w->first = t;
+        w->stride = pool->nWorkers;
+        w->started = t > 0
+                && 0 == pthread_create(&w->id, NULL, eekf_tracker_thread, w);
+        pool->nStarted += w->started;
+    }
+
+    return eEekfReturnOk;
+}
+
+void eekf_tracker_close(eekf_tracker *tr)
+{
+    if (NULL == tr)
+    {
+        return;
+    }
+
+    eekf_tracker_pool *pool = &tr->pool;
+    uint8_t t;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (t = 0; t < pool->nWorkers; t++)
+    {
+        if (pool->workers[t].started)
+        {
+            pthread_join(pool->workers[t].id, NULL);
+            pool->workers[t].started = 0;
+        }
+    }
+    pool->nStarted = 0;
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+eekf_return eekf_tracker_add(eekf_tracker *tr, eekf_mat const *x0,
+        eekf_mat const *P0, uint32_t *id)
+{
+    if (NULL == tr || NULL == x0 || NULL == P0)
+    {
+        return eEekfReturnParameterError;
+    }
+    if (tr->nTracks == tr->maxTracks)
+    {
+        return eEekfReturnQueueFull;
+    }
+
+    eekf_tracker_track *t = tr->tracks + tr->nTracks;
+
+    eekf_tracker_bind(tr, tr->nTracks);
+    if (NULL == eekf_mat_copy(&t->x, x0) || NULL == eekf_mat_copy(&t->P, P0)
+            || eEekfReturnOk
+                    != eekf_init(&t->ctx, &t->x, &t->P, tr->cfg.f, tr->cfg.h,
+                            tr->cfg.userData))
+    {
+        return eEekfReturnParameterError;
+    }
+
+    t->id = tr->nextId++;
+    t->hits = 0;
+    t->misses = 0;
+    t->meas = -1;
+    t->status = eEekfReturnOk;
+    t->gated = 0;
+    t->nGated = 0;
+    tr->nTracks++;
+
+    if (NULL != id)
+    {
+        *id = t->id;
+    }
+
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_tracker_remove(eekf_tracker *tr, uint32_t index)
+{
+    if (NULL == tr || index >= tr->nTracks)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    uint32_t last = --tr->nTracks;
+    uint32_t size = EEKF_TRACKER_TRACK_SIZE(tr->cfg.states, tr->cfg.dim);
+
+    if (index != last)
+    {
+        tr->tracks[index] = tr->tracks[last];
+        memcpy(tr->values + (size_t) index * size,
+                tr->values + (size_t) last * size, sizeof(eekf_value) * size);
+        eekf_tracker_bind(tr, index);
+    }
+
+    return eEekfReturnOk;
+}
+
+eekf_return eekf_tracker_scan(eekf_tracker *tr, eekf_mat const *u,
+        eekf_mat const *Q, eekf_value const *Z, uint32_t nMeas,
+        eekf_mat const *R, uint32_t *unassigned)
+{
+    if (NULL == tr || NULL == u || NULL == Q || (NULL == Z && nMeas > 0)
+            || NULL == R || nMeas > tr->maxMeas
+            || R->rows != tr->cfg.dim || R->cols != tr->cfg.dim
+            || Q->rows != tr->cfg.states || Q->cols != tr->cfg.states)
+    {
+        return eEekfReturnParameterError;
+    }
+
+    eekf_tracker_pool *pool = &tr->pool;
+    uint32_t j;
+    uint8_t t;
+
+    for (t = 0; t < pool->nWorkers; t++)
+    {
+        eekf_tracker_worker *w = pool->workers + t;
+        w->u = u;
+        w->Q = Q;
+        w->Z = Z;
+        w->nMeas = nMeas;
+        w->R = R;
+        memset(&w->stats, 0, sizeof(eekf_tracker_stats));
+    }
+    memset(&tr->stats, 0, sizeof(eekf_tracker_stats));
+    tr->stats.measurements = nMeas;
+
+    // predict and gate in parallel, associate, correct in parallel
+    eekf_tracker_grid(tr, Z, nMeas);
+    eekf_tracker_dispatch(tr, 0);
+    eekf_tracker_auction(tr);
+    eekf_tracker_dispatch(tr, 1);
+
+    for (t = 0; t < pool->nWorkers; t++)
+    {
+        eekf_tracker_stats const *st = &pool->workers[t].stats;
+        tr->stats.candidates += st->candidates;
+        tr->stats.gated += st->gated;
+        tr->stats.truncated += st->truncated;
+        tr->stats.assigned += st->assigned;
+        tr->stats.missed += st->missed;
+        tr->stats.failed += st->failed;
+    }
+
+    // report measurements without track
+    for (j = 0; j < nMeas; j++)
+    {
+        if (tr->meas[j].owner < 0)
+        {
+            if (NULL != unassigned)
+            {
+                unassigned[tr->stats.unassigned] = j;
+            }
+            tr->stats.unassigned++;
+        }
+    }
+
+    return eEekfReturnOk;
+}
@@ -37,29 +37,29 @@
 #include <eekf/eekf.h>
 
 // constant acceleration
-eekf_value a = 0.1;
+double a = 0.1;
 // time step duration
-eekf_value dT = 0.1;
+double dT = 0.1;
 // process noise standard deviation
-eekf_value s_w = 0.2;
+double s_w = 0.2;
 // measurement noise standard deviation
-eekf_value s_z = 10;
+double s_z = 10;
 	
 /// the state prediction function: linear case for simplicity
 eekf_return transition(eekf_mat* xp, eekf_mat* Jf, eekf_mat const *x,
         eekf_mat const *u, void* userData)
 {
 	EEKF_DECL_MAT_INIT(xu, 2, 1, 0);
-	EEKF_DECL_MAT_INIT(B, 2, 1, dT * dT / 2, dT);
+	EEKF_DECL_MAT_INIT(B, 2, 1, EEKF_VALUE(dT * dT / 2), EEKF_VALUE(dT));
 	
     // the Jacobian of transition() at x
-    *EEKF_MAT_EL(*Jf, 0, 0) = 1;
+    *EEKF_MAT_EL(*Jf, 0, 0) = EEKF_VALUE(1);
     *EEKF_MAT_EL(*Jf, 1, 0) = 0;
-    *EEKF_MAT_EL(*Jf, 0, 1) = dT;
-    *EEKF_MAT_EL(*Jf, 1, 1) = 1;
+    *EEKF_MAT_EL(*Jf, 0, 1) = EEKF_VALUE(dT);
+    *EEKF_MAT_EL(*Jf, 1, 1) = EEKF_VALUE(1);
 
-	*EEKF_MAT_EL(B, 0, 0) = dT * dT / 2;
-	*EEKF_MAT_EL(B, 1, 0) = dT;
+	*EEKF_MAT_EL(B, 0, 0) = EEKF_VALUE(dT * dT / 2);
+	*EEKF_MAT_EL(B, 1, 0) = EEKF_VALUE(dT);
 	
     // predict state from current state
     if (NULL == eekf_mat_add(xp, eekf_mat_mul(xp, Jf, x), eekf_mat_mul(&xu, &B, u)))
@@ -76,7 +76,7 @@ eekf_return measurement(eekf_mat* zp, eekf_mat* Jh, eekf_mat const *x,
         void* userData)
 {
     // the Jacobian of measurement() at x
-    *EEKF_MAT_EL(*Jh, 0, 0) = 1;
+    *EEKF_MAT_EL(*Jh, 0, 0) = EEKF_VALUE(1);
     *EEKF_MAT_EL(*Jh, 0, 1) = 0;
 
     // compute the measurement from state x
@@ -92,16 +92,16 @@ int main(int argc, char **argv)
     // state of the filter
     EEKF_DECL_MAT_INIT(x, 2, 1, 0);
     EEKF_DECL_MAT_INIT(P, 2, 2, 
-		pow(s_w, 2) * pow(dT, 4) / 4, pow(s_w, 2) * pow(dT, 3) / 2,
-		pow(s_w, 2) * pow(dT, 3) / 2, pow(s_w, 2) * pow(dT, 2));
+		EEKF_VALUE(pow(s_w, 2) * pow(dT, 4) / 4), EEKF_VALUE(pow(s_w, 2) * pow(dT, 3) / 2),
+		EEKF_VALUE(pow(s_w, 2) * pow(dT, 3) / 2), EEKF_VALUE(pow(s_w, 2) * pow(dT, 2)));
     // input and process noise variables
-    EEKF_DECL_MAT_INIT(u, 1, 1, a);
+    EEKF_DECL_MAT_INIT(u, 1, 1, EEKF_VALUE(a));
     EEKF_DECL_MAT_INIT(Q, 2, 2, 
-		pow(s_w, 2) * pow(dT, 4) / 4, pow(s_w, 2) * pow(dT, 3) / 2,
-		pow(s_w, 2) * pow(dT, 3) / 2, pow(s_w, 2) * pow(dT, 2));
+		EEKF_VALUE(pow(s_w, 2) * pow(dT, 4) / 4), EEKF_VALUE(pow(s_w, 2) * pow(dT, 3) / 2),
+		EEKF_VALUE(pow(s_w, 2) * pow(dT, 3) / 2), EEKF_VALUE(pow(s_w, 2) * pow(dT, 2)));
     // measurement and measurement noise variables
     EEKF_DECL_MAT_INIT(z, 1, 1, 0);
-    EEKF_DECL_MAT_INIT(R, 1, 1, s_z * s_z);
+    EEKF_DECL_MAT_INIT(R, 1, 1, EEKF_VALUE(s_z * s_z));
 
     // initialize the filter context
     eekf_init(&ctx, &x, &P, transition, measurement, NULL);
@@ -115,24 +115,28 @@ int main(int argc, char **argv)
     printf("k x dx P11 P12 P21 P22 rx rdx z\n");
     // loop over time and present some measurements
     int k;
-    eekf_value v = 0, p = 0;
+    double v = 0, p = 0;
     for (k = 0; k < 1000; k++)
     {
         // compute virtual measurement
-        p = *EEKF_MAT_EL(u, 0, 0) / 2.0 * pow(k * dT,2.0);
-        v = *EEKF_MAT_EL(u, 0, 0) * k * dT;
-		*EEKF_MAT_EL(z, 0, 0) = p + eekf_randn() * s_z;
+        p = EEKF_VALUE_TO_REAL(*EEKF_MAT_EL(u, 0, 0)) / 2.0 * pow(k * dT,2.0);
+        v = EEKF_VALUE_TO_REAL(*EEKF_MAT_EL(u, 0, 0)) * k * dT;
+		*EEKF_MAT_EL(z, 0, 0) = EEKF_VALUE(p + EEKF_VALUE_TO_REAL(eekf_randn()) * s_z);
 
         // correct the current filter state
         eekf_correct(&ctx, &z, &R);
 
         // print out
-        printf("%d %f %f %f %f %f %f %f %f %f\n", k, *EEKF_MAT_EL(*ctx.x, 0, 0),
-                *EEKF_MAT_EL(*ctx.x, 1, 0), *EEKF_MAT_EL(*ctx.P, 0, 0),
-                *EEKF_MAT_EL(*ctx.P, 0, 1), *EEKF_MAT_EL(*ctx.P, 1, 0),
-                *EEKF_MAT_EL(*ctx.P, 1, 1), p, v, *EEKF_MAT_EL(z, 0, 0));
-
-		*EEKF_MAT_EL(u, 0, 0) = a;				
+        printf("%d %f %f %f %f %f %f %f %f %f\n", k,
+                EEKF_VALUE_TO_REAL(*EEKF_MAT_EL(*ctx.x, 0, 0)),
+                EEKF_VALUE_TO_REAL(*EEKF_MAT_EL(*ctx.x, 1, 0)),
+                EEKF_VALUE_TO_REAL(*EEKF_MAT_EL(*ctx.P, 0, 0)),
+                EEKF_VALUE_TO_REAL(*EEKF_MAT_EL(*ctx.P, 0, 1)),
+                EEKF_VALUE_TO_REAL(*EEKF_MAT_EL(*ctx.P, 1, 0)),
+                EEKF_VALUE_TO_REAL(*EEKF_MAT_EL(*ctx.P, 1, 1)), p, v,
+                EEKF_VALUE_TO_REAL(*EEKF_MAT_EL(z, 0, 0)));
+
+		*EEKF_MAT_EL(u, 0, 0) = EEKF_VALUE(a);				
         // predict the next filter state
         eekf_predict(&ctx, &u, &Q);
     }
@@ -0,0 +1,269 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+
+/**
+ * Example program that fuses measurements of two sensor threads with the fusion runtime.
+ *
+ * A telemetry thread reads the published estimate meanwhile. The third state counts the
+ * predictions: it has no uncertainty and gains a variance of exactly 1 with each prediction, so
+ * x[2] == P[2][2] holds in every published estimate and a snapshot mixing two of them is detected.
+ * Returns 0 if no measurement was lost and no torn snapshot was read.
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_fusion_example.c
+ * @author      Christian Meißner
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <eekf/eekf_fusion.h>
+#include <eekf/eekf_publish.h>
+
+// constant acceleration
+eekf_value a = 0.1;
+// process noise standard deviation
+eekf_value s_w = 0.2;
+// position and velocity measurement noise standard deviation
+eekf_value s_p = 10;
+eekf_value s_v = 0.5;
+// simulated duration
+eekf_value T = 100;
+
+/// time step of the current prediction, written by prepare() and read by transition()
+eekf_value dT = 0;
+
+/// progress of the sensor threads in simulated milliseconds
+uint32_t progress[2] = { 0, 0 };
+
+/// set when fusion has finished, stops the telemetry thread
+uint32_t done = 0;
+
+/// telemetry thread statistics
+typedef struct
+{
+    eekf_publish *pub;  //!< published estimate to read
+    uint32_t reads;     //!< number of snapshots read
+    uint32_t steps;     //!< number of distinct filter steps seen
+    uint32_t torn;      //!< number of inconsistent or out of order snapshots
+} telemetry;
+
+/// sensor thread setup
+typedef struct
+{
+    eekf_fusion_sensor *sensor; //!< sensor to push to
+    uint8_t index;              //!< index of the sensor (0: position, 1: velocity)
+    eekf_value period;          //!< sampling period
+    eekf_value sigma;           //!< measurement noise standard deviation
+} producer;
+
+/// the state prediction function
+eekf_return transition(eekf_mat* xp, eekf_mat* Jf, eekf_mat const *x,
+        eekf_mat const *u, void* userData)
+{
+    memset(Jf->elements, 0, sizeof(eekf_value) * 9);
+    *EEKF_MAT_EL(*Jf, 0, 0) = 1;
+    *EEKF_MAT_EL(*Jf, 0, 1) = dT;
+    *EEKF_MAT_EL(*Jf, 1, 1) = 1;
+    *EEKF_MAT_EL(*Jf, 2, 2) = 1;
+
+    *EEKF_MAT_EL(*xp, 0, 0) = *EEKF_MAT_EL(*x, 0, 0)
+            + dT * *EEKF_MAT_EL(*x, 1, 0) + dT * dT / 2 * *EEKF_MAT_EL(*u, 0, 0);
+    *EEKF_MAT_EL(*xp, 1, 0) = *EEKF_MAT_EL(*x, 1, 0)
+            + dT * *EEKF_MAT_EL(*u, 0, 0);
+    // count the predictions
+    *EEKF_MAT_EL(*xp, 2, 0) = *EEKF_MAT_EL(*x, 2, 0) + 1;
+
+    return eEekfReturnOk;
+}
+
+/// position and velocity measurement functions, userData points to the measured state index
+eekf_return measurement(eekf_mat* zp, eekf_mat* Jh, eekf_mat const *x,
+        void* userData)
+{
+    uint8_t i = *(uint8_t*) userData;
+
+    *EEKF_MAT_EL(*Jh, 0, 0) = 0 == i;
+    *EEKF_MAT_EL(*Jh, 0, 1) = 1 == i;
+    *EEKF_MAT_EL(*Jh, 0, 2) = 0;
+    *EEKF_MAT_EL(*zp, 0, 0) = *EEKF_MAT_EL(*x, i, 0);
+
+    return eEekfReturnOk;
+}
+
+/// prepare the prediction over dt
+eekf_return prepare(eekf_mat *u, eekf_mat *Q, eekf_value dt, void *userData)
+{
+    dT = dt;
+    *EEKF_MAT_EL(*u, 0, 0) = a;
+    *EEKF_MAT_EL(*Q, 0, 0) = pow(s_w, 2) * pow(dt, 4) / 4;
+    *EEKF_MAT_EL(*Q, 0, 1) = pow(s_w, 2) * pow(dt, 3) / 2;
+    *EEKF_MAT_EL(*Q, 1, 0) = pow(s_w, 2) * pow(dt, 3) / 2;
+    *EEKF_MAT_EL(*Q, 1, 1) = pow(s_w, 2) * pow(dt, 2);
+    // the prediction counter gains a variance of 1 with each prediction
+    *EEKF_MAT_EL(*Q, 2, 2) = 1;
+
+    return eEekfReturnOk;
+}
+
+/// sensor thread: push measurements of the true trajectory at 100 times real time
+void* produce(void *arg)
+{
+    producer *p = (producer*) arg;
+    eekf_rng rng;
+    eekf_value t, z;
+    struct timespec start, due;
+
+    eekf_rng_seed(&rng, 0, p->index);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (t = p->period; t <= T; t += p->period)
+    {
+        // wait for the sampling time
+        long ns = start.tv_nsec + (long) (t * 1e7);
+        due.tv_sec = start.tv_sec + ns / 1000000000L;
+        due.tv_nsec = ns % 1000000000L;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+
+        z = 0 == p->index ? a / 2 * t * t : a * t;
+        z += eekf_randn_r(&rng) * p->sigma;
+        eekf_fusion_push(p->sensor, t, &z);
+        __atomic_store_n(&progress[p->index], (uint32_t) lround(t * 1000),
+                __ATOMIC_RELEASE);
+    }
+
+    return NULL;
+}
+
+/// telemetry thread: sample snapshots of the estimate while the filter is running
+void* observe(void *arg)
+{
+    telemetry *tm = (telemetry*) arg;
+    EEKF_DECL_MAT(x, 3, 1);
+    EEKF_DECL_MAT(P, 3, 3);
+    eekf_value t, count = 0;
+    uint32_t step, last = 0;
+
+    while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE))
+    {
+        eekf_publish_read(tm->pub, &x, &P, &t, &step);
+        tm->reads++;
+        tm->steps += step != last;
+        last = step;
+        // a torn snapshot mixes the counter of x with the one of P, or goes back in time
+        tm->torn += *EEKF_MAT_EL(x, 2, 0) != *EEKF_MAT_EL(P, 2, 2)
+                || *EEKF_MAT_EL(x, 2, 0) < count
+                || *EEKF_MAT_EL(P, 0, 1) != *EEKF_MAT_EL(P, 1, 0);
+        count = *EEKF_MAT_EL(x, 2, 0);
+        usleep(100);
+    }
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    // filter context
+    eekf_context ctx;
+    // state of the filter
+    EEKF_DECL_MAT_INIT(x, 3, 1, 0);
+    EEKF_DECL_MAT_INIT(P, 3, 3, 1, 0, 0, 0, 0.01, 0, 0, 0, 0);
+    // input and process noise variables
+    EEKF_DECL_MAT(u, 1, 1);
+    EEKF_DECL_MAT(Q, 3, 3);
+    // measurement noise of the sensors
+    EEKF_DECL_MAT_INIT(Rp, 1, 1, s_p * s_p);
+    EEKF_DECL_MAT_INIT(Rv, 1, 1, s_v * s_v);
+    // sensors and their queues
+    uint8_t index[2] = { 0, 1 };
+    eekf_fusion_sensor sensors[2];
+    EEKF_FUSION_DECL_QUEUE(qp, 256, 1);
+    EEKF_FUSION_DECL_QUEUE(qv, 256, 1);
+    // fusion runtime
+    eekf_fusion fusion;
+    // published estimate read by the telemetry thread
+    eekf_publish pub;
+    EEKF_PUBLISH_DECL_STORAGE(pub, 3);
+    telemetry tm = { &pub, 0, 0, 0 };
+
+    eekf_init(&ctx, &x, &P, transition, measurement, NULL);
+    eekf_fusion_sensor_init(&sensors[0], qp_slots, qp_values, 256, 1,
+            measurement, &Rp, &index[0]);
+    eekf_fusion_sensor_init(&sensors[1], qv_slots, qv_values, 256, 1,
+            measurement, &Rv, &index[1]);
+    eekf_fusion_init(&fusion, &ctx, 0, sensors, 2, prepare, &u, &Q, NULL);
+    eekf_publish_init(&pub, pub_values, 3);
+    eekf_publish_attach(&ctx, &pub);
+
+    // start sensor threads
+    producer producers[2] =
+    {
+        { &sensors[0], 0, 0.1, s_p },
+        { &sensors[1], 1, 0.02, s_v }
+    };
+    pthread_t threads[3];
+    pthread_create(&threads[0], NULL, produce, &producers[0]);
+    pthread_create(&threads[1], NULL, produce, &producers[1]);
+    // start telemetry thread
+    pthread_create(&threads[2], NULL, observe, &tm);
+
+    // fuse measurements up to the time all sensors have reached
+    eekf_value until = 0;
+    while (until < T)
+    {
+        until = fmin(__atomic_load_n(&progress[0], __ATOMIC_ACQUIRE),
+                __atomic_load_n(&progress[1], __ATOMIC_ACQUIRE)) / 1000.0;
+        eekf_fusion_run(&fusion, until);
+        usleep(50);
+    }
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    eekf_fusion_run(&fusion, INFINITY);
+    __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+    pthread_join(threads[2], NULL);
+
+    // print out
+    printf("t x dx rx rdx\n");
+    printf("%f %f %f %f %f\n", fusion.t, *EEKF_MAT_EL(x, 0, 0),
+            *EEKF_MAT_EL(x, 1, 0), a / 2 * fusion.t * fusion.t, a * fusion.t);
+    printf("reads steps torn\n");
+    printf("%u %u %u\n", tm.reads, tm.steps, tm.torn);
+    printf("sensor pushed dropped late processed failed maxFill\n");
+    int i, lost = 0;
+    for (i = 0; i < 2; i++)
+    {
+        eekf_fusion_stats stats;
+        eekf_fusion_get_stats(&stats, &sensors[i]);
+        printf("%d %u %u %u %u %u %u\n", i, stats.pushed, stats.dropped,
+                stats.late, stats.processed, stats.failed, stats.maxFill);
+        lost += stats.pushed != stats.processed || 0 != stats.dropped
+                || 0 != stats.late || 0 != stats.failed;
+    }
+
+    return 0 != tm.torn || 0 != lost;
+}
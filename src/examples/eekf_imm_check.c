@@ -0,0 +1,163 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+/**
+ * Check program comparing the IMM filter with the extended Kalman filter.
+ *
+ * An IMM of two identical models mixes identical estimates and assigns them identical
+ * likelihoods, so its combined estimate has to reproduce the extended Kalman filter up to
+ * rounding. A model failing during the correction has to leave the IMM unchanged. Returns 0 if
+ * all checks pass.
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_imm_check.c
+ * @author      Christian Meißner
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <eekf/eekf_imm.h>
+
+// time step duration
+eekf_value dT = 0.1;
+// tolerance of the relative deviation
+eekf_value tol = 1e-12;
+
+/// the state transition: constant velocity with the input as acceleration
+eekf_return transition(eekf_mat* xp, eekf_mat* Jf, eekf_mat const *x,
+        eekf_mat const *u, void* userData)
+{
+    EEKF_DECL_MAT_INIT(F, 2, 2, 1, 0, dT, 1);
+    EEKF_DECL_MAT_INIT(B, 2, 1, dT * dT / 2, dT);
+    EEKF_DECL_MAT_DYN(xu, 2, 1);
+
+    eekf_mat_copy(Jf, &F);
+    return NULL == eekf_mat_add(xp, eekf_mat_mul(xp, &F, x),
+            eekf_mat_mul(&xu, &B, u)) ?
+            eEekfReturnComputationFailed : eEekfReturnOk;
+}
+
+/// the measurement z = x0 + 0.1 * x1^2, fails if userData points to a non-zero flag
+eekf_return measurement(eekf_mat* zp, eekf_mat* Jh, eekf_mat const *x,
+        void* userData)
+{
+    eekf_value x1 = *EEKF_MAT_EL(*x, 1, 0);
+
+    if (NULL != userData && *(int*) userData)
+    {
+        return eEekfReturnCallbackFailed;
+    }
+
+    *EEKF_MAT_EL(*Jh, 0, 0) = 1;
+    *EEKF_MAT_EL(*Jh, 0, 1) = 0.2 * x1;
+    *EEKF_MAT_EL(*zp, 0, 0) = *EEKF_MAT_EL(*x, 0, 0) + 0.1 * x1 * x1;
+
+    return eEekfReturnOk;
+}
+
+/// maximum deviation of two matrices relative to the magnitude of the reference B
+eekf_value diff(eekf_mat const *A, eekf_mat const *B)
+{
+    eekf_value d = 0;
+    uint8_t r, c;
+
+    for (c = 0; c < A->cols; c++)
+    {
+        for (r = 0; r < A->rows; r++)
+        {
+            d = fmax(d, fabs(*EEKF_MAT_EL(*A, r, c) - *EEKF_MAT_EL(*B, r, c))
+                    / fmax(1, fabs(*EEKF_MAT_EL(*B, r, c))));
+        }
+    }
+    return d;
+}
+
+/// print and count the result of a check
+int check(char const *name, int passed)
+{
+    printf("%s: %s\n", name, passed ? "passed" : "FAILED");
+    return !passed;
+}
+
+int main(int argc, char **argv)
+{
+    eekf_context ekf;
+    eekf_imm imm;
+    EEKF_DECL_MAT_INIT(x, 2, 1, 0, 1);
+    EEKF_DECL_MAT_INIT(P, 2, 2, 1, 0.1, 0.1, 0.04);
+    EEKF_DECL_MAT_INIT(x0, 2, 1, 0, 1);
+    EEKF_DECL_MAT_INIT(P0, 2, 2, 1, 0.1, 0.1, 0.04);
+    EEKF_DECL_MAT_INIT(u, 1, 1, 0.1);
+    EEKF_DECL_MAT_INIT(Q, 2, 2, 1e-4, 2e-3, 2e-3, 4e-2);
+    EEKF_DECL_MAT_INIT(Pi, 2, 2, 0.9, 0.2, 0.1, 0.8);
+    EEKF_DECL_MAT(z, 1, 1);
+    EEKF_DECL_MAT_INIT(R, 1, 1, 4);
+    eekf_value values[EEKF_IMM_STORAGE_SIZE(2, 2)];
+    eekf_value saved[EEKF_IMM_STORAGE_SIZE(2, 2)];
+    eekf_value mu[2];
+    ekkf_fun_f f[2] = { transition, transition };
+    eekf_mat const *Qs[2] = { &Q, &Q };
+    eekf_rng rng;
+    eekf_value d = 0;
+    int failed = 0, fail = 1;
+    int k;
+
+    eekf_rng_seed(&rng, 1, 0);
+    eekf_init(&ekf, &x, &P, transition, measurement, NULL);
+    if (eEekfReturnOk
+            != eekf_imm_init(&imm, values, 2, &x0, &P0, f, measurement, &Pi,
+                    NULL))
+    {
+        return check("IMM of identical models", 0);
+    }
+
+    // identical models
+    for (k = 0; k < 200; k++)
+    {
+        *EEKF_MAT_EL(z, 0, 0) = 0.005 * k * k + 2 * eekf_randn_r(&rng);
+        if (eEekfReturnOk != eekf_correct(&ekf, &z, &R)
+                || eEekfReturnOk != eekf_imm_correct(&imm, &z, &R)
+                || eEekfReturnOk != eekf_predict(&ekf, &u, &Q)
+                || eEekfReturnOk != eekf_imm_predict(&imm, &u, Qs))
+        {
+            return check("IMM of identical models", 0);
+        }
+        d = fmax(d, fmax(diff(&imm.x, &x), diff(&imm.P, &P)));
+    }
+    printf("maximum relative deviation from the extended Kalman filter %g\n", d);
+    failed += check("IMM of identical models", d < tol);
+
+    // the second model fails after the first one has been linearized
+    memcpy(saved, values, sizeof(values));
+    memcpy(mu, imm.mu, sizeof(mu));
+    imm.models[1].userData = &fail;
+    failed += check("failing model leaves the IMM unchanged",
+            eEekfReturnCallbackFailed == eekf_imm_correct(&imm, &z, &R)
+                    && 0 == memcmp(saved, values, sizeof(values))
+                    && 0 == memcmp(mu, imm.mu, sizeof(mu)));
+
+    return failed;
+}
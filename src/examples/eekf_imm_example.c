@@ -0,0 +1,153 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+/**
+ * Example program that tracks a maneuvering object with an IMM of a constant velocity and a
+ * constant acceleration model.
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_imm_example.c
+ * @author      Christian Meißner
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <eekf/eekf_imm.h>
+
+// time step duration
+eekf_value dT = 0.5;
+// acceleration of the maneuver and its start and end time
+eekf_value a = 0.5;
+eekf_value t0 = 10;
+eekf_value t1 = 15;
+// initial velocity
+eekf_value v0 = 1;
+// process noise standard deviations of the models
+eekf_value s_cv = 0.05;
+eekf_value s_ca = 0.5;
+// measurement noise standard deviation in centimeters
+eekf_value s_z = 100;
+
+/// the state prediction function of the constant velocity model, x = [p, v, a]
+eekf_return transition_cv(eekf_mat* xp, eekf_mat* Jf, eekf_mat const *x,
+        eekf_mat const *u, void* userData)
+{
+    EEKF_DECL_MAT_INIT(F, 3, 3, 1, 0, 0, dT, 1, 0, 0, 0, 0);
+
+    eekf_mat_copy(Jf, &F);
+    return NULL == eekf_mat_mul(xp, &F, x) ?
+            eEekfReturnComputationFailed : eEekfReturnOk;
+}
+
+/// the state prediction function of the constant acceleration model, x = [p, v, a]
+eekf_return transition_ca(eekf_mat* xp, eekf_mat* Jf, eekf_mat const *x,
+        eekf_mat const *u, void* userData)
+{
+    EEKF_DECL_MAT_INIT(F, 3, 3, 1, 0, 0, dT, 1, 0, dT * dT / 2, dT, 1);
+
+    eekf_mat_copy(Jf, &F);
+    return NULL == eekf_mat_mul(xp, &F, x) ?
+            eEekfReturnComputationFailed : eEekfReturnOk;
+}
+
+/// the measurement prediction function, the position is measured
+eekf_return measurement(eekf_mat* zp, eekf_mat* Jh, eekf_mat const *x,
+        void* userData)
+{
+    *EEKF_MAT_EL(*Jh, 0, 0) = 1;
+    *EEKF_MAT_EL(*Jh, 0, 1) = 0;
+    *EEKF_MAT_EL(*Jh, 0, 2) = 0;
+    *EEKF_MAT_EL(*zp, 0, 0) = *EEKF_MAT_EL(*x, 0, 0);
+
+    return eEekfReturnOk;
+}
+
+/// convert the measurement from centimeters to meters once for all models
+eekf_return prepare(eekf_mat *z, eekf_mat *R, void *userData)
+{
+    *EEKF_MAT_EL(*z, 0, 0) /= 100;
+    *EEKF_MAT_EL(*R, 0, 0) /= 100 * 100;
+
+    return eEekfReturnOk;
+}
+
+int main(int argc, char **argv)
+{
+    // the IMM and its storage
+    eekf_imm imm;
+    EEKF_IMM_DECL_STORAGE(imm, 2, 3);
+    // initial estimate
+    EEKF_DECL_MAT_INIT(x0, 3, 1, 0, 0, 0);
+    EEKF_DECL_MAT_INIT(P0, 3, 3, 1, 0, 0, 0, 1, 0, 0, 0, 0.01);
+    // model transition probabilities
+    EEKF_DECL_MAT_INIT(Pi, 2, 2, 0.95, 0.05, 0.05, 0.95);
+    // model functions and process noise covariances (white noise jerk resp. acceleration)
+    ekkf_fun_f f[2] = { transition_cv, transition_ca };
+    EEKF_DECL_MAT_INIT(Qcv, 3, 3,
+            pow(s_cv, 2) * pow(dT, 4) / 4, pow(s_cv, 2) * pow(dT, 3) / 2, 0,
+            pow(s_cv, 2) * pow(dT, 3) / 2, pow(s_cv, 2) * pow(dT, 2), 0,
+            0, 0, 1e-6);
+    EEKF_DECL_MAT_INIT(Qca, 3, 3,
+            pow(s_ca, 2) * pow(dT, 5) / 20, pow(s_ca, 2) * pow(dT, 4) / 8,
+            pow(s_ca, 2) * pow(dT, 3) / 6,
+            pow(s_ca, 2) * pow(dT, 4) / 8, pow(s_ca, 2) * pow(dT, 3) / 3,
+            pow(s_ca, 2) * pow(dT, 2) / 2,
+            pow(s_ca, 2) * pow(dT, 3) / 6, pow(s_ca, 2) * pow(dT, 2) / 2,
+            pow(s_ca, 2) * dT);
+    eekf_mat const *Q[2] = { &Qcv, &Qca };
+    // input and measurement (in centimeters)
+    EEKF_DECL_MAT(u, 1, 1);
+    EEKF_DECL_MAT(z, 1, 1);
+    EEKF_DECL_MAT_INIT(R, 1, 1, s_z * s_z);
+    // true trajectory
+    eekf_value p = 0, v = v0, t;
+    eekf_rng rng;
+
+    eekf_rng_seed(&rng, 0, 0);
+    eekf_imm_init(&imm, imm_values, 2, &x0, &P0, f, measurement, &Pi, NULL);
+    eekf_imm_set_prepare(&imm, prepare, NULL);
+
+    printf("k t x dx ddx mu_cv mu_ca rx rdx rddx\n");
+    int k;
+    for (k = 1; k <= 60; k++)
+    {
+        t = k * dT;
+        // simulate
+        eekf_value at = t > t0 && t <= t1 ? a : 0;
+        p += v * dT + at * dT * dT / 2;
+        v += at * dT;
+        *EEKF_MAT_EL(z, 0, 0) = (p + eekf_randn_r(&rng) * s_z / 100) * 100;
+
+        // filter
+        eekf_imm_predict(&imm, &u, Q);
+        eekf_imm_correct(&imm, &z, &R);
+
+        printf("%d %f %f %f %f %f %f %f %f %f\n", k, t,
+                *EEKF_MAT_EL(imm.x, 0, 0), *EEKF_MAT_EL(imm.x, 1, 0),
+                *EEKF_MAT_EL(imm.x, 2, 0), imm.mu[0], imm.mu[1], p, v, at);
+    }
+
+    return 0;
+}
@@ -0,0 +1,227 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+/**
+ * Check program for the matrix views and strided (ld != rows) matrices.
+ *
+ * Runs copy, mul, chol and fw_sub on aligned matrices and on block, row, column and diagonal
+ * views and compares the results with the ones of packed matrices. Elements outside of a view
+ * written to have to stay untouched. Returns 0 if all checks pass.
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_mat_check.c
+ * @author      Christian Meißner
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+#include <eekf/eekf_mat.h>
+
+// value of elements outside of views
+#define SENTINEL 12345.0
+
+// tolerance of the comparisons
+eekf_value tol = 1e-12;
+
+/// fill a matrix with random values
+void fill(eekf_mat *A)
+{
+    uint8_t r, c;
+
+    for (c = 0; c < A->cols; c++)
+    {
+        for (r = 0; r < A->rows; r++)
+        {
+            *EEKF_MAT_EL(*A, r, c) = (eekf_value) rand() / RAND_MAX - 0.5;
+        }
+    }
+}
+
+/// fill a matrix with the sentinel value
+void fill_sentinel(eekf_mat *A)
+{
+    uint8_t r, c;
+
+    for (c = 0; c < A->cols; c++)
+    {
+        for (r = 0; r < A->rows; r++)
+        {
+            *EEKF_MAT_EL(*A, r, c) = SENTINEL;
+        }
+    }
+}
+
+/// check that all elements of W outside of the block at (r0, c0) hold the sentinel value
+int untouched(eekf_mat const *W, uint8_t r0, uint8_t c0, uint8_t rows,
+        uint8_t cols)
+{
+    uint8_t r, c;
+
+    for (c = 0; c < W->cols; c++)
+    {
+        for (r = 0; r < W->rows; r++)
+        {
+            int inside = r >= r0 && r < r0 + rows && c >= c0 && c < c0 + cols;
+            if (!inside && SENTINEL != *EEKF_MAT_EL(*W, r, c))
+            {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/// maximum absolute difference of two matrices of equal dimensions
+eekf_value diff(eekf_mat const *A, eekf_mat const *B)
+{
+    eekf_value d = 0;
+    uint8_t r, c;
+
+    if (A->rows != B->rows || A->cols != B->cols)
+    {
+        return INFINITY;
+    }
+    for (c = 0; c < A->cols; c++)
+    {
+        for (r = 0; r < A->rows; r++)
+        {
+            d = fmax(d, fabs(*EEKF_MAT_EL(*A, r, c) - *EEKF_MAT_EL(*B, r, c)));
+        }
+    }
+    return d;
+}
+
+/// report a check
+int check(char const *name, int passed)
+{
+    printf("%s: %s\n", name, passed ? "passed" : "FAILED");
+    return !passed;
+}
+
+int main(int argc, char **argv)
+{
+    EEKF_DECL_MAT(G, 5, 5);
+    EEKF_DECL_MAT(Gt, 5, 5);
+    EEKF_DECL_MAT(A, 5, 5);
+    EEKF_DECL_MAT(L, 5, 5);
+    EEKF_DECL_MAT(B, 5, 3);
+    EEKF_DECL_MAT(X, 5, 3);
+    EEKF_DECL_MAT(C, 5, 3);
+    EEKF_DECL_MAT_ALIGNED(Aa, 5, 5);
+    EEKF_DECL_MAT_ALIGNED(La, 5, 5);
+    EEKF_DECL_MAT_ALIGNED(Xa, 5, 3);
+    EEKF_DECL_MAT(W, 9, 8);
+    EEKF_DECL_MAT(B2, 5, 6);
+    EEKF_DECL_MAT(WX, 7, 4);
+    EEKF_DECL_MAT(WC, 8, 3);
+    eekf_mat V, VL, VB, VX, VC, D;
+    eekf_value trace = 0, sum = 0;
+    int failed = 0;
+    uint8_t i, c;
+
+    srand(0);
+
+    // symmetric positive definite A = G * G' + I
+    fill(&G);
+    eekf_mat_mul(&A, &G, eekf_mat_trs(&Gt, &G));
+    for (i = 0; i < 5; i++)
+    {
+        *EEKF_MAT_EL(A, i, i) += 1;
+    }
+    fill(&B);
+
+    // packed references
+    eekf_mat_chol(&L, &A);
+    eekf_mat_fw_sub(&X, &L, &B);
+    eekf_mat_mul(&C, &A, &B);
+
+    // aligned matrices have padded columns
+    failed += check("aligned layout", Aa.ld != Aa.rows
+            && 0 == (uintptr_t) EEKF_MAT_COL(Aa, 1) % EEKF_MAT_ALIGN
+            && 0 == (uintptr_t) EEKF_MAT_COL(Aa, 4) % EEKF_MAT_ALIGN);
+
+    // copy, chol and fw_sub on aligned matrices
+    failed += check("aligned chol and fw_sub",
+            NULL != eekf_mat_copy(&Aa, &A) && 0 == diff(&Aa, &A)
+                    && NULL != eekf_mat_chol(&La, &Aa) && diff(&La, &L) < tol
+                    && NULL != eekf_mat_fw_sub(&Xa, &La, &B)
+                    && diff(&Xa, &X) < tol);
+
+    // chol into a block view, its surrounding stays untouched
+    fill_sentinel(&W);
+    failed += check("chol into block view",
+            NULL != eekf_mat_block(&VL, &W, 2, 1, 5, 5)
+                    && NULL != eekf_mat_chol(&VL, &A) && diff(&VL, &L) < tol
+                    && untouched(&W, 2, 1, 5, 5));
+
+    // fw_sub with the view as L, a column view as B and a block view as result
+    for (c = 0; c < 3; c++)
+    {
+        for (i = 0; i < 5; i++)
+        {
+            *EEKF_MAT_EL(B2, i, c + 2) = *EEKF_MAT_EL(B, i, c);
+        }
+    }
+    fill_sentinel(&WX);
+    failed += check("fw_sub on views",
+            NULL != eekf_mat_cols(&VB, &B2, 2, 3)
+                    && NULL != eekf_mat_block(&VX, &WX, 1, 1, 5, 3)
+                    && NULL != eekf_mat_fw_sub(&VX, &VL, &VB)
+                    && diff(&VX, &X) < tol && untouched(&WX, 1, 1, 5, 3));
+
+    // mul of a block view of W into a row view of a larger matrix
+    fill_sentinel(&WC);
+    fill_sentinel(&W);
+    eekf_mat_block(&V, &W, 3, 2, 5, 5);
+    eekf_mat_copy(&V, &A);
+    failed += check("mul into row view",
+            NULL != eekf_mat_rows(&VC, &WC, 2, 5)
+                    && NULL != eekf_mat_mul(&VC, &V, &B)
+                    && diff(&VC, &C) < tol && untouched(&WC, 2, 0, 5, 3));
+
+    // a strided view cannot be reshaped, a block outside of the matrix is rejected
+    failed += check("invalid views rejected",
+            NULL == eekf_mat_mul(&VC, &V, &V)
+                    && NULL == eekf_mat_block(&V, &W, 5, 0, 5, 1)
+                    && NULL == eekf_mat_cols(&V, &W, 6, 3));
+
+    // diagonal view reads and writes the diagonal
+    eekf_mat_diag(&D, &A);
+    for (i = 0; i < 5; i++)
+    {
+        trace += *EEKF_MAT_EL(A, i, i);
+        *EEKF_MAT_EL(D, 0, i) += 1;
+    }
+    for (i = 0; i < D.cols; i++)
+    {
+        sum += *EEKF_MAT_EL(D, 0, i) - 1;
+    }
+    failed += check("diagonal view", 1 == D.rows && 5 == D.cols
+            && fabs(sum - trace) < tol
+            && *EEKF_MAT_EL(A, 1, 0) == *EEKF_MAT_EL(A, 0, 1));
+
+    return failed;
+}
@@ -0,0 +1,134 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+
+/**
+ * Example program that tunes the process noise of the example filter with the Monte Carlo harness.
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_mc_example.c
+ * @author      Christian Meißner
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <eekf/eekf_mc.h>
+
+// constant acceleration
+eekf_value a = 0.1;
+// time step duration
+eekf_value dT = 0.1;
+// true process noise standard deviation
+eekf_value s_w = 0.2;
+// true measurement noise standard deviation
+eekf_value s_z = 10;
+
+/// the state prediction function: linear case for simplicity
+eekf_return transition(eekf_mat* xp, eekf_mat* Jf, eekf_mat const *x,
+        eekf_mat const *u, void* userData)
+{
+    EEKF_DECL_MAT_INIT(xu, 2, 1, 0);
+    EEKF_DECL_MAT_INIT(B, 2, 1, dT * dT / 2, dT);
+
+    // the Jacobian of transition() at x
+    *EEKF_MAT_EL(*Jf, 0, 0) = 1;
+    *EEKF_MAT_EL(*Jf, 1, 0) = 0;
+    *EEKF_MAT_EL(*Jf, 0, 1) = dT;
+    *EEKF_MAT_EL(*Jf, 1, 1) = 1;
+
+    // predict state from current state
+    if (NULL == eekf_mat_add(xp, eekf_mat_mul(xp, Jf, x), eekf_mat_mul(&xu, &B, u)))
+    {
+        return eEekfReturnComputationFailed;
+    }
+
+    return eEekfReturnOk;
+}
+
+/// the measurement prediction function
+eekf_return measurement(eekf_mat* zp, eekf_mat* Jh, eekf_mat const *x,
+        void* userData)
+{
+    // the Jacobian of measurement() at x
+    *EEKF_MAT_EL(*Jh, 0, 0) = 1;
+    *EEKF_MAT_EL(*Jh, 0, 1) = 0;
+
+    // compute the measurement from state x
+    *EEKF_MAT_EL(*zp, 0, 0) = *EEKF_MAT_EL(*x, 0, 0);
+
+    return eEekfReturnOk;
+}
+
+int main(int argc, char **argv)
+{
+    // initial state and its uncertainty
+    EEKF_DECL_MAT_INIT(x0, 2, 1, 0);
+    EEKF_DECL_MAT_INIT(P0, 2, 2, 1, 0, 0, 0.01);
+    EEKF_DECL_MAT_INIT(x0Sqrt, 2, 2, 1, 0, 0, 0.1);
+    // input
+    EEKF_DECL_MAT_INIT(u, 1, 1, a);
+    // true process and measurement noise
+    EEKF_DECL_MAT_INIT(QtSqrt, 2, 1, s_w * dT * dT / 2, s_w * dT);
+    EEKF_DECL_MAT_INIT(RtSqrt, 1, 1, s_z);
+    // filter process and measurement noise
+    EEKF_DECL_MAT(Q, 2, 2);
+    EEKF_DECL_MAT_INIT(R, 1, 1, s_z * s_z);
+    // results
+    EEKF_DECL_MAT(rmse, 2, 1);
+
+    eekf_mc_config cfg =
+    {
+        .truthF = transition, .truthH = measurement, .truthUserData = NULL,
+        .f = transition, .h = measurement, .userData = NULL,
+        .x0 = &x0, .P0 = &P0, .x0Sqrt = &x0Sqrt, .u = &u,
+        .Q = &Q, .R = &R, .QtSqrt = &QtSqrt, .RtSqrt = &RtSqrt,
+        .steps = 500, .trials = 2000, .seed = 0, .threads = 0
+    };
+    eekf_mc_result res = { .rmse = &rmse };
+
+    // sweep the filter's process noise around the true value, the consistent
+    // filter yields NEES close to 2 and NIS close to 1
+    printf("s_w nees nis rmse_x rmse_dx failed\n");
+    eekf_value scale;
+    for (scale = 0.25; scale <= 4; scale *= 2)
+    {
+        eekf_value s = scale * s_w;
+        *EEKF_MAT_EL(Q, 0, 0) = pow(s, 2) * pow(dT, 4) / 4;
+        *EEKF_MAT_EL(Q, 0, 1) = pow(s, 2) * pow(dT, 3) / 2;
+        *EEKF_MAT_EL(Q, 1, 0) = pow(s, 2) * pow(dT, 3) / 2;
+        *EEKF_MAT_EL(Q, 1, 1) = pow(s, 2) * pow(dT, 2);
+
+        if (eEekfReturnOk != eekf_mc_run(&res, &cfg))
+        {
+            printf("simulation failed\n");
+            return 1;
+        }
+
+        printf("%f %f %f %f %f %u\n", s, res.nees, res.nis,
+                *EEKF_MAT_EL(rmse, 0, 0), *EEKF_MAT_EL(rmse, 1, 0), res.failed);
+    }
+
+    return 0;
+}
@@ -0,0 +1,228 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+/**
+ * Check program comparing the partial-state prediction and correction with the full ones.
+ *
+ * With all states active the partial functions have to match eekf_predict() and eekf_correct().
+ * With consider states the frozen part of x and P has to stay untouched, while the active part
+ * of x and the active rows and columns of P have to match the dense consider (Schmidt) update
+ * computed with eekf_correct(). Returns 0 if all checks pass.
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_partial_check.c
+ * @author      Christian Meißner
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <eekf/eekf.h>
+
+// time step duration
+eekf_value dT = 0.1;
+// tolerance of the comparisons
+eekf_value tol = 1e-12;
+
+/// the state prediction function, states 1 and 3 are constant biases
+eekf_return transition(eekf_mat* xp, eekf_mat* Jf, eekf_mat const *x,
+        eekf_mat const *u, void* userData)
+{
+    eekf_value x1 = *EEKF_MAT_EL(*x, 1, 0);
+    eekf_value x3 = *EEKF_MAT_EL(*x, 3, 0);
+
+    memset(Jf->elements, 0, sizeof(eekf_value) * 16);
+    *EEKF_MAT_EL(*Jf, 0, 0) = 1;
+    *EEKF_MAT_EL(*Jf, 0, 1) = dT;
+    *EEKF_MAT_EL(*Jf, 1, 1) = 1;
+    *EEKF_MAT_EL(*Jf, 2, 2) = 1;
+    *EEKF_MAT_EL(*Jf, 2, 3) = dT * cos(x3);
+    *EEKF_MAT_EL(*Jf, 3, 3) = 1;
+
+    *EEKF_MAT_EL(*xp, 0, 0) = *EEKF_MAT_EL(*x, 0, 0) + dT * x1;
+    *EEKF_MAT_EL(*xp, 1, 0) = x1;
+    *EEKF_MAT_EL(*xp, 2, 0) = *EEKF_MAT_EL(*x, 2, 0) + dT * sin(x3);
+    *EEKF_MAT_EL(*xp, 3, 0) = x3;
+
+    return eEekfReturnOk;
+}
+
+/// the measurement prediction function
+eekf_return measurement(eekf_mat* zp, eekf_mat* Jh, eekf_mat const *x,
+        void* userData)
+{
+    eekf_value x2 = *EEKF_MAT_EL(*x, 2, 0);
+
+    memset(Jh->elements, 0, sizeof(eekf_value) * 8);
+    *EEKF_MAT_EL(*Jh, 0, 0) = 1;
+    *EEKF_MAT_EL(*Jh, 0, 1) = 0.5;
+    *EEKF_MAT_EL(*Jh, 1, 2) = 0.2 * x2;
+    *EEKF_MAT_EL(*Jh, 1, 3) = 1;
+
+    *EEKF_MAT_EL(*zp, 0, 0) = *EEKF_MAT_EL(*x, 0, 0)
+            + 0.5 * *EEKF_MAT_EL(*x, 1, 0);
+    *EEKF_MAT_EL(*zp, 1, 0) = 0.1 * x2 * x2 + *EEKF_MAT_EL(*x, 3, 0);
+
+    return eEekfReturnOk;
+}
+
+/// maximum absolute difference of two matrices
+eekf_value diff(eekf_mat const *A, eekf_mat const *B)
+{
+    eekf_value d = 0;
+    uint8_t r, c;
+
+    for (c = 0; c < A->cols; c++)
+    {
+        for (r = 0; r < A->rows; r++)
+        {
+            d = fmax(d, fabs(*EEKF_MAT_EL(*A, r, c) - *EEKF_MAT_EL(*B, r, c)));
+        }
+    }
+    return d;
+}
+
+/// report a check
+int check(char const *name, int passed)
+{
+    printf("%s: %s\n", name, passed ? "passed" : "FAILED");
+    return !passed;
+}
+
+int main(int argc, char **argv)
+{
+    eekf_context full, part;
+    EEKF_DECL_MAT_INIT(x1, 4, 1, 1, 0.2, -0.5, 0.3);
+    EEKF_DECL_MAT_INIT(P1, 4, 4, 1, 0.1, 0, 0, 0.1, 0.5, 0, 0.05,
+            0, 0, 2, 0.2, 0, 0.05, 0.2, 0.4);
+    EEKF_DECL_MAT(x2, 4, 1);
+    EEKF_DECL_MAT(P2, 4, 4);
+    EEKF_DECL_MAT(xf, 4, 1);
+    EEKF_DECL_MAT(Pf, 4, 4);
+    EEKF_DECL_MAT(u, 1, 1);
+    // process noise on the non-bias states only
+    EEKF_DECL_MAT_INIT(Q, 4, 4, 0.01, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.02, 0,
+            0, 0, 0, 0);
+    EEKF_DECL_MAT_INIT(R, 2, 2, 0.5, 0.1, 0.1, 0.3);
+    EEKF_DECL_MAT(z, 2, 1);
+    uint8_t all[4] = { 3, 1, 0, 2 };
+    uint8_t active[2] = { 0, 2 };
+    uint8_t twice[3] = { 0, 2, 0 };
+    eekf_value dAll = 0, dFrozen = 0, dConsider = 0;
+    int failed = 0;
+    uint8_t r, c;
+    int k;
+
+    eekf_mat_copy(&x2, &x1);
+    eekf_mat_copy(&P2, &P1);
+    eekf_init(&full, &x1, &P1, transition, measurement, NULL);
+    eekf_init(&part, &x2, &P2, transition, measurement, NULL);
+
+    // all states active
+    for (k = 0; k < 20; k++)
+    {
+        *EEKF_MAT_EL(z, 0, 0) = 1 + 0.05 * k;
+        *EEKF_MAT_EL(z, 1, 0) = 0.4 + 0.1 * sin(k);
+        if (eEekfReturnOk != eekf_predict(&full, &u, &Q)
+                || eEekfReturnOk != eekf_predict_partial(&part, &u, &Q, all, 4)
+                || eEekfReturnOk != eekf_correct(&full, &z, &R)
+                || eEekfReturnOk
+                        != eekf_correct_partial(&part, &z, &R, all, 4))
+        {
+            return check("all states active", 0);
+        }
+        dAll = fmax(dAll, fmax(diff(&x1, &x2), diff(&P1, &P2)));
+    }
+    printf("maximum deviation with all states active %g\n", dAll);
+    failed += check("all states active", dAll < tol);
+
+    // consider states 1 and 3 stay frozen, the active part follows the dense consider update
+    for (k = 0; k < 20; k++)
+    {
+        eekf_mat_copy(&x1, &x2);
+        eekf_mat_copy(&P1, &P2);
+        *EEKF_MAT_EL(z, 0, 0) = 2 + 0.05 * k;
+        *EEKF_MAT_EL(z, 1, 0) = 0.4 - 0.1 * cos(k);
+        // the bias rows of Jf are unit rows without noise, the full prediction is the partial one
+        if (eEekfReturnOk != eekf_predict(&full, &u, &Q)
+                || eEekfReturnOk
+                        != eekf_predict_partial(&part, &u, &Q, active, 2))
+        {
+            return check("consider states frozen", 0);
+        }
+        dConsider = fmax(dConsider, fmax(diff(&x1, &x2), diff(&P1, &P2)));
+        eekf_mat_copy(&xf, &x2);
+        eekf_mat_copy(&Pf, &P2);
+        // the active rows of K P H' S^-1 are those of the Schmidt gain, so the active part of x
+        // and the active rows and columns of P - K S K' are the consider update
+        if (eEekfReturnOk != eekf_correct(&full, &z, &R)
+                || eEekfReturnOk
+                        != eekf_correct_partial(&part, &z, &R, active, 2))
+        {
+            return check("consider states frozen", 0);
+        }
+        for (r = 0; r < 4; r++)
+        {
+            if (0 == r % 2)
+            {
+                dConsider = fmax(dConsider, fabs(*EEKF_MAT_EL(x2, r, 0)
+                        - *EEKF_MAT_EL(x1, r, 0)));
+            }
+            else
+            {
+                dFrozen = fmax(dFrozen, fabs(*EEKF_MAT_EL(x2, r, 0)
+                        - *EEKF_MAT_EL(xf, r, 0)));
+            }
+            for (c = 0; c < 4; c++)
+            {
+                if (0 == r % 2 || 0 == c % 2)
+                {
+                    dConsider = fmax(dConsider, fabs(*EEKF_MAT_EL(P2, r, c)
+                            - *EEKF_MAT_EL(P1, r, c)));
+                }
+                else
+                {
+                    dFrozen = fmax(dFrozen, fabs(*EEKF_MAT_EL(P2, r, c)
+                            - *EEKF_MAT_EL(Pf, r, c)));
+                }
+            }
+        }
+    }
+    printf("maximum deviation from the dense consider update %g\n", dConsider);
+    failed += check("consider states frozen", 0 == dFrozen);
+    failed += check("active states follow the consider update", dConsider < tol);
+
+    // duplicate active states are rejected without touching the state
+    eekf_mat_copy(&xf, &x2);
+    eekf_mat_copy(&Pf, &P2);
+    failed += check("duplicate active states rejected",
+            eEekfReturnParameterError
+                    == eekf_correct_partial(&part, &z, &R, twice, 3)
+                    && eEekfReturnParameterError
+                            == eekf_predict_partial(&part, &u, &Q, twice, 3)
+                    && 0 == diff(&x2, &xf) && 0 == diff(&P2, &Pf));
+
+    return failed;
+}
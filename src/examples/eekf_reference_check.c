@@ -0,0 +1,145 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+/**
+ * Check program of the fixed-point build.
+ *
+ * Tracks a slowly moving target with measurements from an integer noise generator, so every input
+ * is bit-exact on all platforms. The states, covariances and innovation statistics of each step
+ * are printed as raw fixed-point integers; make check builds the program for every number of
+ * fractional bits with a reference output (eekf_reference_check_q<frac>.ref) and compares the
+ * output bit by bit. The values fit Q16.16 and Q2.30, and the innovation covariance settles below
+ * e^-4, where the logarithm of its Cholesky factor is below the Q2.30 range. The program thus also
+ * checks log det(S) and the NIS against double precision computations on the same fixed-point
+ * values. Returns 0 if these checks pass.
+ *
+ * Regenerate a reference output after an intended change of the arithmetic with
+ * build/examples/eekf_reference_check_fixed > src/examples/eekf_reference_check_q<frac>.ref
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_reference_check.c
+ * @author      Christian Meißner
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+#include <eekf/eekf.h>
+
+// time step duration
+double dT = 0.1;
+// velocity of the target
+double v = 0.02;
+// amplitude of the uniform measurement noise
+double n_z = 0.11;
+// process noise standard deviation
+double s_w = 0.1;
+// tolerance of the innovation statistics
+double tol = 1e-2;
+
+/// the state prediction function: constant velocity
+eekf_return transition(eekf_mat* xp, eekf_mat* Jf, eekf_mat const *x,
+        eekf_mat const *u, void* userData)
+{
+    *EEKF_MAT_EL(*Jf, 0, 0) = EEKF_VALUE(1);
+    *EEKF_MAT_EL(*Jf, 1, 0) = 0;
+    *EEKF_MAT_EL(*Jf, 0, 1) = EEKF_VALUE(dT);
+    *EEKF_MAT_EL(*Jf, 1, 1) = EEKF_VALUE(1);
+
+    return NULL == eekf_mat_mul(xp, Jf, x) ?
+            eEekfReturnComputationFailed : eEekfReturnOk;
+}
+
+/// the measurement prediction function: position
+eekf_return measurement(eekf_mat* zp, eekf_mat* Jh, eekf_mat const *x,
+        void* userData)
+{
+    *EEKF_MAT_EL(*Jh, 0, 0) = EEKF_VALUE(1);
+    *EEKF_MAT_EL(*Jh, 0, 1) = 0;
+    *EEKF_MAT_EL(*zp, 0, 0) = *EEKF_MAT_EL(*x, 0, 0);
+
+    return eEekfReturnOk;
+}
+
+/// integer noise generator (xorshift32), uniform in [-1000, 1000]
+int32_t noise(uint32_t *s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return (int32_t) (*s % 2001) - 1000;
+}
+
+int main(int argc, char **argv)
+{
+    eekf_context ctx;
+    EEKF_DECL_MAT_INIT(x, 2, 1, EEKF_VALUE(0.2), 0);
+    EEKF_DECL_MAT_INIT(P, 2, 2, EEKF_VALUE(0.04), 0, 0, EEKF_VALUE(0.01));
+    EEKF_DECL_MAT(u, 1, 1);
+    EEKF_DECL_MAT_INIT(Q, 2, 2,
+            EEKF_VALUE(s_w * s_w * dT * dT * dT * dT / 4),
+            EEKF_VALUE(s_w * s_w * dT * dT * dT / 2),
+            EEKF_VALUE(s_w * s_w * dT * dT * dT / 2),
+            EEKF_VALUE(s_w * s_w * dT * dT));
+    EEKF_DECL_MAT(z, 1, 1);
+    EEKF_DECL_MAT_INIT(R, 1, 1, EEKF_VALUE(n_z * n_z / 3));
+    eekf_innovation inno;
+    uint32_t seed = 2463534242u;
+    double S, dz, nis, dLog = 0, dNis = 0;
+    int k;
+
+    eekf_init(&ctx, &x, &P, transition, measurement, NULL);
+
+    for (k = 0; k < 300; k++)
+    {
+        *EEKF_MAT_EL(z, 0, 0) = EEKF_VALUE(0.2 + v * k * dT
+                + n_z * noise(&seed) / 1000);
+        // innovation statistics from the predicted fixed-point values
+        S = EEKF_VALUE_TO_REAL(*EEKF_MAT_EL(P, 0, 0))
+                + EEKF_VALUE_TO_REAL(*EEKF_MAT_EL(R, 0, 0));
+        dz = EEKF_VALUE_TO_REAL(*EEKF_MAT_EL(z, 0, 0))
+                - EEKF_VALUE_TO_REAL(*EEKF_MAT_EL(x, 0, 0));
+        if (eEekfReturnOk != eekf_correct_innovation(&ctx, &z, &R, &inno)
+                || eEekfReturnOk != eekf_predict(&ctx, &u, &Q))
+        {
+            fprintf(stderr, "filter step %d failed\n", k);
+            return 1;
+        }
+        dLog = fmax(dLog, fabs(EEKF_WIDE_TO_REAL(inno.logDetS) - log(S)));
+        // the whitened innovation saturates at EEKF_VALUE_MAX_REAL
+        nis = fmin(dz * dz / S, EEKF_VALUE_MAX_REAL * EEKF_VALUE_MAX_REAL);
+        dNis = fmax(dNis, fabs(EEKF_WIDE_TO_REAL(inno.nis) - nis) / fmax(1, nis));
+
+        printf("%d %d %d %d %d %d %d %lld %lld\n", k,
+                (int) *EEKF_MAT_EL(x, 0, 0), (int) *EEKF_MAT_EL(x, 1, 0),
+                (int) *EEKF_MAT_EL(P, 0, 0), (int) *EEKF_MAT_EL(P, 0, 1),
+                (int) *EEKF_MAT_EL(P, 1, 0), (int) *EEKF_MAT_EL(P, 1, 1),
+                (long long) inno.nis, (long long) inno.logDetS);
+    }
+
+    fprintf(stderr, "maximum deviation of log det(S) %g, relative deviation of the NIS %g: %s\n",
+            dLog, dNis, dLog < tol && dNis < tol ? "passed" : "FAILED");
+    return !(dLog < tol && dNis < tol);
+}
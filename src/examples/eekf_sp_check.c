@@ -0,0 +1,182 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+/**
+ * Check program comparing the sigma-point filter with the extended Kalman filter.
+ *
+ * For a linear model the sigma points capture mean and covariance exactly, so the cubature rule
+ * and the unscented transformation have to reproduce the estimates of the extended Kalman filter
+ * up to rounding. Returns 0 if all checks pass.
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_sp_check.c
+ * @author      Christian Meißner
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <eekf/eekf_sp.h>
+
+// time step duration
+eekf_value dT = 0.1;
+// tolerance of the relative deviation
+eekf_value tol = 1e-12;
+
+/// the linear state transition of the extended Kalman filter: xp = F * x + B * u
+eekf_return transition(eekf_mat* xp, eekf_mat* Jf, eekf_mat const *x,
+        eekf_mat const *u, void* userData)
+{
+    EEKF_DECL_MAT_INIT(F, 2, 2, 1, 0, dT, 1);
+    EEKF_DECL_MAT_INIT(B, 2, 1, dT * dT / 2, dT);
+    EEKF_DECL_MAT_DYN(xu, 2, 1);
+
+    eekf_mat_copy(Jf, &F);
+    return NULL == eekf_mat_add(xp, eekf_mat_mul(xp, &F, x),
+            eekf_mat_mul(&xu, &B, u)) ?
+            eEekfReturnComputationFailed : eEekfReturnOk;
+}
+
+/// the linear measurement of the extended Kalman filter: z = x0 + 0.5 * x1
+eekf_return measurement(eekf_mat* zp, eekf_mat* Jh, eekf_mat const *x,
+        void* userData)
+{
+    *EEKF_MAT_EL(*Jh, 0, 0) = 1;
+    *EEKF_MAT_EL(*Jh, 0, 1) = 0.5;
+    *EEKF_MAT_EL(*zp, 0, 0) = *EEKF_MAT_EL(*x, 0, 0)
+            + 0.5 * *EEKF_MAT_EL(*x, 1, 0);
+
+    return eEekfReturnOk;
+}
+
+/// the same state transition evaluated on all sigma points
+eekf_return transition_sp(eekf_mat *Xp, eekf_mat const *X, eekf_mat const *u,
+        void *userData)
+{
+    EEKF_DECL_MAT(x, 2, 1);
+    EEKF_DECL_MAT(xp, 2, 1);
+    EEKF_DECL_MAT(Jf, 2, 2);
+    uint8_t c;
+
+    for (c = 0; c < X->cols; c++)
+    {
+        *EEKF_MAT_EL(x, 0, 0) = *EEKF_MAT_EL(*X, 0, c);
+        *EEKF_MAT_EL(x, 1, 0) = *EEKF_MAT_EL(*X, 1, c);
+        transition(&xp, &Jf, &x, u, userData);
+        *EEKF_MAT_EL(*Xp, 0, c) = *EEKF_MAT_EL(xp, 0, 0);
+        *EEKF_MAT_EL(*Xp, 1, c) = *EEKF_MAT_EL(xp, 1, 0);
+    }
+
+    return eEekfReturnOk;
+}
+
+/// the same measurement evaluated on all sigma points
+eekf_return measurement_sp(eekf_mat *Z, eekf_mat const *X, void *userData)
+{
+    uint8_t c;
+
+    for (c = 0; c < X->cols; c++)
+    {
+        *EEKF_MAT_EL(*Z, 0, c) = *EEKF_MAT_EL(*X, 0, c)
+                + 0.5 * *EEKF_MAT_EL(*X, 1, c);
+    }
+
+    return eEekfReturnOk;
+}
+
+/// maximum deviation of two matrices relative to the magnitude of the reference B
+eekf_value diff(eekf_mat const *A, eekf_mat const *B)
+{
+    eekf_value d = 0;
+    uint8_t r, c;
+
+    for (c = 0; c < A->cols; c++)
+    {
+        for (r = 0; r < A->rows; r++)
+        {
+            d = fmax(d, fabs(*EEKF_MAT_EL(*A, r, c) - *EEKF_MAT_EL(*B, r, c))
+                    / fmax(1, fabs(*EEKF_MAT_EL(*B, r, c))));
+        }
+    }
+    return d;
+}
+
+/// run both filters on the same measurements, returns the maximum relative deviation
+eekf_value run(eekf_value alpha, eekf_value beta, eekf_value kappa)
+{
+    eekf_context ekf;
+    eekf_sp_context sp;
+    EEKF_DECL_MAT_INIT(x1, 2, 1, 0, 0);
+    EEKF_DECL_MAT_INIT(P1, 2, 2, 1, 0.1, 0.1, 0.04);
+    EEKF_DECL_MAT_INIT(x2, 2, 1, 0, 0);
+    EEKF_DECL_MAT_INIT(P2, 2, 2, 1, 0.1, 0.1, 0.04);
+    EEKF_DECL_MAT_INIT(u, 1, 1, 0.1);
+    EEKF_DECL_MAT_INIT(Q, 2, 2, 1e-4, 2e-3, 2e-3, 4e-2);
+    EEKF_DECL_MAT(z, 1, 1);
+    EEKF_DECL_MAT_INIT(R, 1, 1, 4);
+    eekf_rng rng;
+    eekf_value d = 0;
+    int k;
+
+    eekf_rng_seed(&rng, 1, 0);
+    eekf_init(&ekf, &x1, &P1, transition, measurement, NULL);
+    eekf_sp_init(&sp, &x2, &P2, transition_sp, measurement_sp, NULL);
+    if (eEekfReturnOk != eekf_sp_set_params(&sp, alpha, beta, kappa))
+    {
+        return INFINITY;
+    }
+
+    for (k = 0; k < 200; k++)
+    {
+        *EEKF_MAT_EL(z, 0, 0) = 0.005 * k * k + 2 * eekf_randn_r(&rng);
+        if (eEekfReturnOk != eekf_correct(&ekf, &z, &R)
+                || eEekfReturnOk != eekf_sp_correct(&sp, &z, &R)
+                || eEekfReturnOk != eekf_predict(&ekf, &u, &Q)
+                || eEekfReturnOk != eekf_sp_predict(&sp, &u, &Q))
+        {
+            return INFINITY;
+        }
+        d = fmax(d, fmax(diff(&x2, &x1), diff(&P2, &P1)));
+    }
+
+    return d;
+}
+
+int main(int argc, char **argv)
+{
+    int failed = 0;
+    eekf_value d;
+
+    d = run(1, 0, 0);
+    printf("cubature rule: maximum relative deviation %g: %s\n", d,
+            d < tol ? "passed" : "FAILED");
+    failed += !(d < tol);
+
+    d = run(0.5, 2, 1);
+    printf("unscented transformation: maximum relative deviation %g: %s\n", d,
+            d < tol ? "passed" : "FAILED");
+    failed += !(d < tol);
+
+    return failed;
+}
@@ -0,0 +1,245 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+/**
+ * Example program that tracks thousands of objects moving on a plane with the multi-target
+ * tracker. The number of objects grows while their density stays constant, so the time per scan
+ * should grow about linearly. After each run the program checks which fraction of the objects is
+ * followed by a confirmed track within 3 standard deviations and fails if it is too low.
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_tracker_example.c
+ * @author      Christian Meißner
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#include <eekf/eekf_tracker.h>
+
+/// maximum number of objects
+#define MAX_OBJECTS 4000
+
+// time step duration
+eekf_value dT = 1;
+// mean distance between objects
+eekf_value spacing = 50;
+// object speed standard deviation per axis
+eekf_value s_v = 1;
+// process noise (acceleration) standard deviation
+eekf_value s_w = 0.05;
+// measurement noise standard deviation
+eekf_value s_z = 1;
+// detection probability and number of clutter measurements per object
+double pD = 0.9;
+double clutter = 0.05;
+// number of scans per run
+int scans = 20;
+// minimum fraction of objects followed by a confirmed track
+double minTracked = 0.9;
+
+// tracker pools
+EEKF_TRACKER_DECL_STORAGE(pool, 2 * MAX_OBJECTS, 2 * MAX_OBJECTS, 8192, 4, 2)
+
+// simulated objects [px, py, vx, vy]
+eekf_value objects[MAX_OBJECTS][4];
+// measurements and unassigned measurements of a scan
+eekf_value Z[2 * 2 * MAX_OBJECTS];
+uint32_t unassigned[2 * MAX_OBJECTS];
+
+/// the state prediction function, constant velocity
+eekf_return transition(eekf_mat* xp, eekf_mat* Jf, eekf_mat const *x,
+        eekf_mat const *u, void* userData)
+{
+    EEKF_DECL_MAT_INIT(F, 4, 4, 1, 0, 0, 0, 0, 1, 0, 0, dT, 0, 1, 0, 0, dT, 0, 1);
+
+    eekf_mat_copy(Jf, &F);
+    return NULL == eekf_mat_mul(xp, &F, x) ?
+            eEekfReturnComputationFailed : eEekfReturnOk;
+}
+
+/// the measurement prediction function, the position is measured
+eekf_return measurement(eekf_mat* zp, eekf_mat* Jh, eekf_mat const *x,
+        void* userData)
+{
+    EEKF_DECL_MAT_INIT(H, 2, 4, 1, 0, 0, 1, 0, 0, 0, 0);
+
+    eekf_mat_copy(Jh, &H);
+    return NULL == eekf_mat_mul(zp, &H, x) ?
+            eEekfReturnComputationFailed : eEekfReturnOk;
+}
+
+/// check whether a confirmed track is within 3 standard deviations of the object position
+int tracked(eekf_tracker const *tr, eekf_value const *object)
+{
+    uint32_t i;
+
+    for (i = 0; i < tr->nTracks; i++)
+    {
+        eekf_tracker_track const *t = tr->tracks + i;
+        eekf_value dx = object[0] - *EEKF_MAT_EL(t->x, 0, 0);
+        eekf_value dy = object[1] - *EEKF_MAT_EL(t->x, 1, 0);
+        eekf_value a = *EEKF_MAT_EL(t->P, 0, 0);
+        eekf_value b = *EEKF_MAT_EL(t->P, 0, 1);
+        eekf_value c = *EEKF_MAT_EL(t->P, 1, 1);
+        eekf_value det = a * c - b * b;
+
+        // squared Mahalanobis distance of the position with the inverse of the 2 x 2 block of P
+        if (t->hits >= 5 && det > 0
+                && (c * dx * dx - 2 * b * dx * dy + a * dy * dy) / det <= 9)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/// uniformly distributed random number in [0, 1)
+double randu()
+{
+    return rand() / (RAND_MAX + 1.0);
+}
+
+int main(int argc, char **argv)
+{
+    eekf_tracker tr;
+    eekf_tracker_config cfg =
+    {
+        .f = transition,
+        .h = measurement,
+        .userData = NULL,
+        .states = 4,
+        .dim = 2,
+        .axes = { 0, 1 },
+        .cellSize = 10,
+        .gamma = 9.21, // 99% of the chi-square distribution with 2 degrees of freedom
+        .epsilon = 1e-3,
+        .threads = 0
+    };
+    EEKF_DECL_MAT(u, 1, 1);
+    EEKF_DECL_MAT_INIT(Q, 4, 4,
+            pow(s_w, 2) * pow(dT, 4) / 4, 0, pow(s_w, 2) * pow(dT, 3) / 2, 0,
+            0, pow(s_w, 2) * pow(dT, 4) / 4, 0, pow(s_w, 2) * pow(dT, 3) / 2,
+            pow(s_w, 2) * pow(dT, 3) / 2, 0, pow(s_w, 2) * pow(dT, 2), 0,
+            0, pow(s_w, 2) * pow(dT, 3) / 2, 0, pow(s_w, 2) * pow(dT, 2));
+    EEKF_DECL_MAT_INIT(R, 2, 2, s_z * s_z, 0, 0, s_z * s_z);
+    EEKF_DECL_MAT(x0, 4, 1);
+    EEKF_DECL_MAT_INIT(P0, 4, 4, s_z * s_z, 0, 0, 0, 0, s_z * s_z, 0, 0,
+            0, 0, 4 * s_v * s_v, 0, 0, 0, 0, 4 * s_v * s_v);
+    eekf_rng rng;
+
+    srand(0);
+    eekf_rng_seed(&rng, 0, 0);
+
+    int failed = 0;
+
+    printf("objects tracks confirmed tracked candidates gated bids assigned missed unassigned ms\n");
+    uint32_t n;
+    for (n = MAX_OBJECTS / 8; n <= MAX_OBJECTS; n *= 2)
+    {
+        eekf_value side = sqrt(n) * spacing;
+        double ms = 0;
+        uint32_t i, j, k;
+        int s;
+
+        eekf_tracker_init(&tr, &cfg, pool_tracks, pool_values, 2 * MAX_OBJECTS,
+                pool_meas, 2 * MAX_OBJECTS, pool_buckets, 8192);
+        for (i = 0; i < n; i++)
+        {
+            objects[i][0] = randu() * side;
+            objects[i][1] = randu() * side;
+            objects[i][2] = eekf_randn_r(&rng) * s_v;
+            objects[i][3] = eekf_randn_r(&rng) * s_v;
+        }
+
+        for (s = 0; s < scans; s++)
+        {
+            uint32_t nMeas = 0;
+            struct timespec t0, t1;
+
+            // simulate detections and clutter
+            for (i = 0; i < n; i++)
+            {
+                objects[i][0] += objects[i][2] * dT;
+                objects[i][1] += objects[i][3] * dT;
+                if (randu() < pD)
+                {
+                    Z[2 * nMeas] = objects[i][0] + eekf_randn_r(&rng) * s_z;
+                    Z[2 * nMeas + 1] = objects[i][1] + eekf_randn_r(&rng) * s_z;
+                    nMeas++;
+                }
+            }
+            for (k = 0; k < n * clutter; k++, nMeas++)
+            {
+                Z[2 * nMeas] = randu() * side;
+                Z[2 * nMeas + 1] = randu() * side;
+            }
+
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            eekf_tracker_scan(&tr, &u, &Q, Z, nMeas, &R, unassigned);
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            ms += (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+
+            // delete tracks missed three times in a row, start tracks on unassigned measurements
+            for (i = tr.nTracks; i > 0; i--)
+            {
+                if (tr.tracks[i - 1].misses >= 3)
+                {
+                    eekf_tracker_remove(&tr, i - 1);
+                }
+            }
+            for (j = 0; j < tr.stats.unassigned; j++)
+            {
+                *EEKF_MAT_EL(x0, 0, 0) = Z[2 * unassigned[j]];
+                *EEKF_MAT_EL(x0, 1, 0) = Z[2 * unassigned[j] + 1];
+                eekf_tracker_add(&tr, &x0, &P0, NULL);
+            }
+        }
+
+        // tracks with at least five hits count as confirmed
+        uint32_t confirmed = 0, found = 0;
+        for (i = 0; i < tr.nTracks; i++)
+        {
+            confirmed += tr.tracks[i].hits >= 5;
+        }
+        for (i = 0; i < n; i++)
+        {
+            found += tracked(&tr, objects[i]);
+        }
+        printf("%u %u %u %f %u %u %u %u %u %u %f\n", n, tr.nTracks, confirmed,
+                (double) found / n, tr.stats.candidates, tr.stats.gated,
+                tr.stats.bids, tr.stats.assigned, tr.stats.missed,
+                tr.stats.unassigned, ms / scans);
+        failed |= found < minTracked * n;
+
+        eekf_tracker_close(&tr);
+    }
+
+    if (failed)
+    {
+        printf("less than %g of the objects are tracked: FAILED\n", minTracked);
+    }
+    return failed;
+}
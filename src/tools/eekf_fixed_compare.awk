@@ -0,0 +1,34 @@
+# Compares the output of the fixed-point example program with the floating-point one.
+#
+# usage: awk -v frac=16 -f eekf_fixed_compare.awk eekf_example.out eekf_example_fixed.out
+#
+# Both programs run on the same measurements (columns: k x dx P11 P12 P21 P22 rx rdx z). The
+# fixed-point estimate has to stay within 0.1 standard deviations of the floating-point one and
+# each covariance entry within 5 % of sqrt(Pii * Pjj) plus 4 fixed-point steps of frac
+# fractional bits. Exits non-zero on the first violation.
+
+function abs(v) { return v < 0 ? -v : v }
+function max(a, b) { return a > b ? a : b }
+
+BEGIN { eps = 4 / 2 ^ frac }
+
+NR == FNR { ref[FNR] = $0; n = FNR; next }
+
+FNR > 1 {
+	split(ref[FNR], r)
+	if (r[1] != $1) { failed = "step mismatch in line " FNR; exit 1 }
+	sx = sqrt(r[4]); sdx = sqrt(r[7])
+	ex = abs($2 - r[2]) / sx; edx = abs($3 - r[3]) / sdx
+	ep = abs($4 - r[4]) - 0.05 * r[4]
+	ep = max(ep, abs($5 - r[5]) - 0.05 * sx * sdx)
+	ep = max(ep, abs($6 - r[6]) - 0.05 * sx * sdx)
+	ep = max(ep, abs($7 - r[7]) - 0.05 * r[7])
+	mx = max(mx, max(ex, edx))
+	if (ex > 0.1 || edx > 0.1 || ep > eps) { failed = "deviation at step " $0; exit 1 }
+}
+
+END {
+	if (!failed && FNR != n) { failed = "line count mismatch" }
+	if (failed) { print failed; exit 1 }
+	printf "maximum estimate deviation %g standard deviations\n", mx
+}
@@ -0,0 +1,865 @@
+/***********************************************************************************
+ * The MIT License (MIT)                                                           *
+ *                                                                                 *
+ * Copyright (c) 2015 Christian Meißner                                            *
+ *                                                                                 *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    *
+ * of this software and associated documentation files (the "Software"), to deal   *
+ * in the Software without restriction, including without limitation the rights    *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       *
+ * copies of the Software, and to permit persons to whom the Software is           *
+ * furnished to do so, subject to the following conditions:                        *
+ *                                                                                 *
+ * The above copyright notice and this permission notice shall be included in all  *
+ * copies or substantial portions of the Software.                                 *
+ *                                                                                 *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE     *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE   *
+ * SOFTWARE.                                                                       *
+ ***********************************************************************************/
+
+/**
+ * Host tool generating model-specific predict and correct functions.
+ *
+ * The generator reads a model description holding the dimensions and the structural pattern of
+ * the Jacobians Jf, Jh and the noise covariances Q, R. It emits a C source and header with
+ * fully unrolled predict and correct functions sharing the eekf_context interface of
+ * eekf_predict() and eekf_correct(). Multiplications by structural zeros are skipped and
+ * multiplications by structural ones are replaced by additions. Optionally a check program is
+ * emitted, which compares the generated functions with the generic ones.
+ *
+ * Model description format (whitespace separated, '#' starts a comment):
+ *
+ *   name ca             # prefix of the generated files and functions, a C identifier
+ *   states 2            # N
+ *   measurements 1      # M
+ *   F                   # N x N pattern of Jf in row order
+ *   1 x
+ *   0 1
+ *   H                   # M x N pattern of Jh
+ *   1 0
+ *   Q                   # N x N pattern of Q, symmetric
+ *   x x
+ *   x x
+ *   R                   # M x M pattern of R, symmetric
+ *   x
+ *
+ * Pattern entries are 0 (structural zero), 1 (structural one, F and H only) or x (run time
+ * value). Usage: eekf_gen [-t] [-o outdir] model
+ *
+ * @copyright   The MIT Licence
+ * @file        eekf_gen.c
+ * @author      Christian Meißner
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/// maximum number of states and measurements
+#define EEKF_GEN_MAX 64
+
+/// model description
+typedef struct
+{
+    char name[64];                              //!< prefix of files and functions
+    uint8_t N;                                  //!< number of states
+    uint8_t M;                                  //!< number of measurements
+    char F[EEKF_GEN_MAX][EEKF_GEN_MAX];         //!< pattern of Jf
+    char H[EEKF_GEN_MAX][EEKF_GEN_MAX];         //!< pattern of Jh
+    char Q[EEKF_GEN_MAX][EEKF_GEN_MAX];         //!< pattern of Q
+    char R[EEKF_GEN_MAX][EEKF_GEN_MAX];         //!< pattern of R
+} eekf_gen_model;
+
+/// term of a dot product
+typedef struct
+{
+    char a[32];     //!< expression of the first factor
+    char b[32];     //!< expression of the second factor, empty for a structural one
+} eekf_gen_term;
+
+// read next token skipping white space and comments, returns 0 at end of file
+static int eekf_gen_token(FILE *in, char *tok, size_t size)
+{
+    int c;
+    size_t n = 0;
+
+    for (;;)
+    {
+        c = fgetc(in);
+        if ('#' == c)
+        {
+            while (EOF != c && '\n' != c)
+            {
+                c = fgetc(in);
+            }
+        }
+        if (EOF == c)
+        {
+            break;
+        }
+        if (' ' == c || '\t' == c || '\n' == c || '\r' == c)
+        {
+            if (n > 0)
+            {
+                break;
+            }
+            continue;
+        }
+        if (n + 1 < size)
+        {
+            tok[n++] = (char) c;
+        }
+    }
+    tok[n] = 0;
+
+    return n > 0;
+}
+
+// read a rows x cols pattern, allowing structural ones if ones is set
+static int eekf_gen_pattern(FILE *in, char p[EEKF_GEN_MAX][EEKF_GEN_MAX],
+        uint8_t rows, uint8_t cols, int ones, char const *what)
+{
+    char tok[64];
+    uint8_t r, c;
+
+    for (r = 0; r < rows; r++)
+    {
+        for (c = 0; c < cols; c++)
+        {
+            if (!eekf_gen_token(in, tok, sizeof(tok)) || 0 != tok[1]
+                    || ('0' != tok[0] && 'x' != tok[0]
+                            && ('1' != tok[0] || !ones)))
+            {
+                fprintf(stderr, "eekf_gen: invalid entry (%u,%u) of %s\n", r, c,
+                        what);
+                return 0;
+            }
+            p[r][c] = tok[0];
+        }
+    }
+
+    return 1;
+}
+
+// check that a n x n pattern is symmetric, only its upper triangle is generated
+static int eekf_gen_symmetric(char p[EEKF_GEN_MAX][EEKF_GEN_MAX], uint8_t n,
+        char const *what)
+{
+    uint8_t r, c;
+
+    for (r = 0; r < n; r++)
+    {
+        for (c = r + 1; c < n; c++)
+        {
+            if (p[r][c] != p[c][r])
+            {
+                fprintf(stderr, "eekf_gen: %s is not symmetric at (%u,%u)\n",
+                        what, r, c);
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+// check that a name is a C identifier, it is used in file names and symbols
+static int eekf_gen_identifier(char const *name)
+{
+    int i;
+
+    for (i = 0; name[i]; i++)
+    {
+        if (!('_' == name[i] || (name[i] >= 'a' && name[i] <= 'z')
+                || (name[i] >= 'A' && name[i] <= 'Z')
+                || (i > 0 && name[i] >= '0' && name[i] <= '9')))
+        {
+            return 0;
+        }
+    }
+
+    return i > 0;
+}
+
+// parse a model description
+static int eekf_gen_parse(eekf_gen_model *m, FILE *in)
+{
+    char tok[64];
+    int have = 0;
+
+    memset(m, 0, sizeof(eekf_gen_model));
+    while (eekf_gen_token(in, tok, sizeof(tok)))
+    {
+        if (0 == strcmp(tok, "name"))
+        {
+            if (!eekf_gen_token(in, m->name, sizeof(m->name))
+                    || !eekf_gen_identifier(m->name))
+            {
+                fprintf(stderr, "eekf_gen: name must match [A-Za-z_][A-Za-z0-9_]*\n");
+                return 0;
+            }
+        }
+        else if (0 == strcmp(tok, "states") || 0 == strcmp(tok, "measurements"))
+        {
+            char num[16];
+            int v;
+            if (!eekf_gen_token(in, num, sizeof(num)) || (v = atoi(num)) < 1
+                    || v > EEKF_GEN_MAX)
+            {
+                fprintf(stderr, "eekf_gen: invalid dimension of %s\n", tok);
+                return 0;
+            }
+            if ('s' == tok[0])
+            {
+                m->N = (uint8_t) v;
+            }
+            else
+            {
+                m->M = (uint8_t) v;
+            }
+        }
+        else if (0 == m->N || 0 == m->M)
+        {
+            fprintf(stderr, "eekf_gen: dimensions must precede patterns\n");
+            return 0;
+        }
+        else if (0 == strcmp(tok, "F"))
+        {
+            have |= eekf_gen_pattern(in, m->F, m->N, m->N, 1, "F") << 0;
+        }
+        else if (0 == strcmp(tok, "H"))
+        {
+            have |= eekf_gen_pattern(in, m->H, m->M, m->N, 1, "H") << 1;
+        }
+        else if (0 == strcmp(tok, "Q"))
+        {
+            have |= (eekf_gen_pattern(in, m->Q, m->N, m->N, 0, "Q")
+                    && eekf_gen_symmetric(m->Q, m->N, "Q")) << 2;
+        }
+        else if (0 == strcmp(tok, "R"))
+        {
+            have |= (eekf_gen_pattern(in, m->R, m->M, m->M, 0, "R")
+                    && eekf_gen_symmetric(m->R, m->M, "R")) << 3;
+        }
+        else
+        {
+            fprintf(stderr, "eekf_gen: unknown keyword %s\n", tok);
+            return 0;
+        }
+    }
+
+    if (0 == m->name[0] || 0xf != have)
+    {
+        fprintf(stderr, "eekf_gen: name, F, H, Q and R are required\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+// emit dst = init + sum of terms, init may be NULL, terms with empty b are structural ones
+static void eekf_gen_dot(FILE *out, char const *dst, char const *init,
+        eekf_gen_term const *terms, int n, int sub)
+{
+    int i;
+
+    // plain copies need no accumulator
+    if (NULL == init && 0 == n)
+    {
+        fprintf(out, "    %s = 0;\n", dst);
+        return;
+    }
+    if (NULL == init && 1 == n && 0 == terms[0].b[0] && !sub)
+    {
+        fprintf(out, "    %s = %s;\n", dst, terms[0].a);
+        return;
+    }
+    if (NULL != init && 0 == n)
+    {
+        if (0 != strcmp(dst, init))
+        {
+            fprintf(out, "    %s = %s;\n", dst, init);
+        }
+        return;
+    }
+
+    if (NULL == init)
+    {
+        fprintf(out, "    acc = 0;\n");
+    }
+    else
+    {
+        fprintf(out, "    acc = EEKF_ACC(%s);\n", init);
+    }
+    for (i = 0; i < n; i++)
+    {
+        if (0 == terms[i].b[0])
+        {
+            // structural ones accumulate saturating as well
+            fprintf(out, "    acc = EEKF_%s(acc, %s, EEKF_VALUE(1));\n",
+                    sub ? "MSC" : "MAC", terms[i].a);
+        }
+        else
+        {
+            fprintf(out, "    acc = EEKF_%s(acc, %s, %s);\n", sub ? "MSC" : "MAC",
+                    terms[i].a, terms[i].b);
+        }
+    }
+    fprintf(out, "    %s = EEKF_ACC_VALUE(acc);\n", dst);
+}
+
+static void eekf_gen_emit_header(FILE *out, eekf_gen_model const *m,
+        char const *guard)
+{
+    fprintf(out, "/* generated by eekf_gen, do not edit */\n\n");
+    fprintf(out, "#ifndef %s_H\n#define %s_H\n\n", guard, guard);
+    fprintf(out, "#include <eekf/eekf.h>\n\n");
+    fprintf(out, "/// number of states of the model\n#define %s_N %u\n", guard, m->N);
+    fprintf(out, "/// number of measurements of the model\n#define %s_M %u\n\n", guard,
+            m->M);
+    fprintf(out, "/**\n * Predict the next filter state, specialized eekf_predict().\n *\n"
+            " * ctx->f must fill all non structural entries of Jf.\n */\n");
+    fprintf(out, "eekf_return %s_predict(eekf_context *ctx, eekf_mat const *u,\n"
+            "        eekf_mat const *Q);\n\n", m->name);
+    fprintf(out, "/**\n * Correct the current filter state, specialized eekf_correct().\n *\n"
+            " * ctx->h must fill all non structural entries of Jh.\n */\n");
+    fprintf(out, "eekf_return %s_correct(eekf_context *ctx, eekf_mat const *z,\n"
+            "        eekf_mat const *R);\n\n", m->name);
+    fprintf(out, "#endif /* %s_H */\n", guard);
+}
+
+static void eekf_gen_emit_source(FILE *out, eekf_gen_model const *m)
+{
+    uint8_t N = m->N, M = m->M;
+    int i, j, k, n;
+    eekf_gen_term terms[2 * EEKF_GEN_MAX];
+    char dst[64], init[64];
+
+    fprintf(out, "/* generated by eekf_gen, do not edit */\n\n");
+    fprintf(out, "#include \"%s.h\"\n\n", m->name);
+    fprintf(out, "#include <eekf/eekf_publish.h>\n\n");
+    fprintf(out, "#include <stddef.h>\n#include <math.h>\n\n");
+    fprintf(out, "#define P_(r, c) (*EEKF_MAT_EL(*ctx->P, (r), (c)))\n");
+    fprintf(out, "#define X_(r) (*EEKF_MAT_EL(*ctx->x, (r), 0))\n\n");
+
+    // prediction P = F * P * F' + Q
+    fprintf(out, "eekf_return %s_predict(eekf_context *ctx, eekf_mat const *u,\n"
+            "        eekf_mat const *Q)\n{\n", m->name);
+    fprintf(out, "    if (NULL == ctx || NULL == u || NULL == Q || %u != ctx->x->rows\n"
+            "            || %u != Q->rows || %u != Q->cols)\n    {\n"
+            "        return eEekfReturnParameterError;\n    }\n\n", N, N, N);
+    fprintf(out, "    EEKF_DECL_MAT(Jf, %u, %u);\n    EEKF_DECL_MAT(xp, %u, 1);\n", N, N,
+            N);
+    fprintf(out, "    eekf_value T[%u][%u];\n    eekf_acc acc;\n\n", N, N);
+    fprintf(out, "    // predict state and linearize system: x1 = f(x,u), Jf = df(x,u)/dx\n"
+            "    if (NULL != ctx->f\n"
+            "            && eEekfReturnOk != ctx->f(&xp, &Jf, ctx->x, u, ctx->userData))\n"
+            "    {\n        return eEekfReturnCallbackFailed;\n    }\n");
+    for (i = 0; i < N; i++)
+    {
+        fprintf(out, "    X_(%d) = *EEKF_MAT_EL(xp, %d, 0);\n", i, i);
+    }
+
+    fprintf(out, "\n    // T = Jf * P\n");
+    for (i = 0; i < N; i++)
+    {
+        for (j = 0; j < N; j++)
+        {
+            for (k = 0, n = 0; k < N; k++)
+            {
+                if ('0' == m->F[i][k])
+                {
+                    continue;
+                }
+                sprintf(terms[n].a, "P_(%d, %d)", k, j);
+                if ('1' == m->F[i][k])
+                {
+                    terms[n].b[0] = 0;
+                }
+                else
+                {
+                    sprintf(terms[n].b, "*EEKF_MAT_EL(Jf, %d, %d)", i, k);
+                }
+                n++;
+            }
+            sprintf(dst, "T[%d][%d]", i, j);
+            eekf_gen_dot(out, dst, NULL, terms, n, 0);
+        }
+    }
+
+    fprintf(out, "\n    // P = T * Jf' + Q\n");
+    for (i = 0; i < N; i++)
+    {
+        for (j = i; j < N; j++)
+        {
+            for (k = 0, n = 0; k < N; k++)
+            {
+                if ('0' == m->F[j][k])
+                {
+                    continue;
+                }
+                sprintf(terms[n].a, "T[%d][%d]", i, k);
+                if ('1' == m->F[j][k])
+                {
+                    terms[n].b[0] = 0;
+                }
+                else
+                {
+                    sprintf(terms[n].b, "*EEKF_MAT_EL(Jf, %d, %d)", j, k);
+                }
+                n++;
+            }
+            sprintf(dst, "P_(%d, %d)", i, j);
+            sprintf(init, "*EEKF_MAT_EL(*Q, %d, %d)", i, j);
+            eekf_gen_dot(out, dst, 'x' == m->Q[i][j] ? init : NULL, terms, n, 0);
+            if (i != j)
+            {
+                fprintf(out, "    P_(%d, %d) = P_(%d, %d);\n", j, i, i, j);
+            }
+        }
+    }
+    fprintf(out, "\n    (void) acc;\n"
+            "    eekf_publish_step(ctx->publish, ctx->x, ctx->P);\n"
+            "    return eEekfReturnOk;\n}\n\n");
+
+    // correction
+    fprintf(out, "eekf_return %s_correct(eekf_context *ctx, eekf_mat const *z,\n"
+            "        eekf_mat const *R)\n{\n", m->name);
+    fprintf(out, "    if (NULL == ctx || NULL == z || NULL == R || %u != ctx->x->rows\n"
+            "            || %u != z->rows || %u != R->rows || %u != R->cols)\n    {\n"
+            "        return eEekfReturnParameterError;\n    }\n\n", N, M, M, M);
+    fprintf(out, "    EEKF_DECL_MAT(Jh, %u, %u);\n    EEKF_DECL_MAT(zp, %u, 1);\n", M, N,
+            M);
+    fprintf(out, "    eekf_value C[%u][%u];\n    eekf_value S[%u][%u];\n", N, M, M, M);
+    fprintf(out, "    eekf_value L[%u][%u];\n    eekf_value U[%u][%u];\n", M, M, N, M);
+    fprintf(out, "    eekf_value w[%u];\n    eekf_acc acc;\n\n", M);
+    fprintf(out, "    // predict measurement and linearize measurement: zp = h(x), Jh = dh(x)/dx\n"
+            "    if (NULL != ctx->h\n"
+            "            && eEekfReturnOk != ctx->h(&zp, &Jh, ctx->x, ctx->userData))\n"
+            "    {\n        return eEekfReturnCallbackFailed;\n    }\n");
+
+    fprintf(out, "\n    // cross covariance C = P * Jh'\n");
+    for (i = 0; i < N; i++)
+    {
+        for (j = 0; j < M; j++)
+        {
+            for (k = 0, n = 0; k < N; k++)
+            {
+                if ('0' == m->H[j][k])
+                {
+                    continue;
+                }
+                sprintf(terms[n].a, "P_(%d, %d)", i, k);
+                if ('1' == m->H[j][k])
+                {
+                    terms[n].b[0] = 0;
+                }
+                else
+                {
+                    sprintf(terms[n].b, "*EEKF_MAT_EL(Jh, %d, %d)", j, k);
+                }
+                n++;
+            }
+            sprintf(dst, "C[%d][%d]", i, j);
+            eekf_gen_dot(out, dst, NULL, terms, n, 0);
+        }
+    }
+
+    fprintf(out, "\n    // innovation covariance S = Jh * C + R\n");
+    for (i = 0; i < M; i++)
+    {
+        for (j = i; j < M; j++)
+        {
+            for (k = 0, n = 0; k < N; k++)
+            {
+                if ('0' == m->H[i][k])
+                {
+                    continue;
+                }
+                sprintf(terms[n].a, "C[%d][%d]", k, j);
+                if ('1' == m->H[i][k])
+                {
+                    terms[n].b[0] = 0;
+                }
+                else
+                {
+                    sprintf(terms[n].b, "*EEKF_MAT_EL(Jh, %d, %d)", i, k);
+                }
+                n++;
+            }
+            sprintf(dst, "S[%d][%d]", i, j);
+            sprintf(init, "*EEKF_MAT_EL(*R, %d, %d)", i, j);
+            eekf_gen_dot(out, dst, 'x' == m->R[i][j] ? init : NULL, terms, n, 0);
+        }
+    }
+
+    fprintf(out, "\n    // cholesky factorization S = L * L'\n");
+    for (j = 0; j < M; j++)
+    {
+        for (k = 0; k < j; k++)
+        {
+            sprintf(terms[k].a, "L[%d][%d]", j, k);
+            sprintf(terms[k].b, "L[%d][%d]", j, k);
+        }
+        sprintf(dst, "L[%d][%d]", j, j);
+        sprintf(init, "S[%d][%d]", j, j);
+        eekf_gen_dot(out, dst, init, terms, j, 1);
+        fprintf(out, "    if (L[%d][%d] <= 0)\n    {\n"
+                "        return eEekfReturnComputationFailed;\n    }\n", j, j);
+        fprintf(out, "    L[%d][%d] = EEKF_VALUE_SQRT(L[%d][%d]);\n", j, j, j, j);
+        for (i = j + 1; i < M; i++)
+        {
+            for (k = 0; k < j; k++)
+            {
+                sprintf(terms[k].a, "L[%d][%d]", i, k);
+                sprintf(terms[k].b, "L[%d][%d]", j, k);
+            }
+            sprintf(dst, "L[%d][%d]", i, j);
+            sprintf(init, "S[%d][%d]", j, i);
+            eekf_gen_dot(out, dst, init, terms, j, 1);
+            fprintf(out, "    L[%d][%d] = EEKF_DIV(L[%d][%d], L[%d][%d]);\n", i, j, i,
+                    j, j, j);
+        }
+    }
+
+    fprintf(out, "\n    // U = (L \\ C')'\n");
+    for (i = 0; i < N; i++)
+    {
+        for (j = 0; j < M; j++)
+        {
+            for (k = 0; k < j; k++)
+            {
+                sprintf(terms[k].a, "L[%d][%d]", j, k);
+                sprintf(terms[k].b, "U[%d][%d]", i, k);
+            }
+            sprintf(dst, "U[%d][%d]", i, j);
+            sprintf(init, "C[%d][%d]", i, j);
+            eekf_gen_dot(out, dst, init, terms, j, 1);
+            fprintf(out, "    U[%d][%d] = EEKF_DIV(U[%d][%d], L[%d][%d]);\n", i, j, i,
+                    j, j, j);
+        }
+    }
+
+    fprintf(out, "\n    // w = L \\ (z - zp)\n");
+    for (j = 0; j < M; j++)
+    {
+        for (k = 0; k < j; k++)
+        {
+            sprintf(terms[k].a, "L[%d][%d]", j, k);
+            sprintf(terms[k].b, "w[%d]", k);
+        }
+        sprintf(dst, "w[%d]", j);
+        sprintf(init, "EEKF_SUB(*EEKF_MAT_EL(*z, %d, 0), *EEKF_MAT_EL(zp, %d, 0))",
+                j, j);
+        fprintf(out, "    w[%d] = %s;\n", j, init);
+        sprintf(init, "w[%d]", j);
+        eekf_gen_dot(out, dst, init, terms, j, 1);
+        fprintf(out, "    w[%d] = EEKF_DIV(w[%d], L[%d][%d]);\n", j, j, j, j);
+    }
+
+    fprintf(out, "\n    // correct state x = x + U * w\n");
+    for (i = 0; i < N; i++)
+    {
+        for (k = 0; k < M; k++)
+        {
+            sprintf(terms[k].a, "U[%d][%d]", i, k);
+            sprintf(terms[k].b, "w[%d]", k);
+        }
+        sprintf(dst, "X_(%d)", i);
+        eekf_gen_dot(out, dst, dst, terms, M, 0);
+    }
+
+    fprintf(out, "\n    // correct covariance P = P - U * U'\n");
+    for (i = 0; i < N; i++)
+    {
+        for (j = i; j < N; j++)
+        {
+            for (k = 0; k < M; k++)
+            {
+                sprintf(terms[k].a, "U[%d][%d]", i, k);
+                sprintf(terms[k].b, "U[%d][%d]", j, k);
+            }
+            sprintf(dst, "P_(%d, %d)", i, j);
+            eekf_gen_dot(out, dst, dst, terms, M, 1);
+            if (i != j)
+            {
+                fprintf(out, "    P_(%d, %d) = P_(%d, %d);\n", j, i, i, j);
+            }
+        }
+    }
+    fprintf(out, "\n    (void) acc;\n"
+            "    eekf_publish_step(ctx->publish, ctx->x, ctx->P);\n"
+            "    return eEekfReturnOk;\n}\n");
+}
+
+static void eekf_gen_emit_check(FILE *out, eekf_gen_model const *m)
+{
+    uint8_t N = m->N, M = m->M;
+    int r;
+
+    fprintf(out, "/* generated by eekf_gen, do not edit */\n\n");
+    fprintf(out, "#include <stdio.h>\n#include <stdlib.h>\n#include <string.h>\n"
+            "#include <math.h>\n\n#include \"%s.h\"\n\n", m->name);
+    fprintf(out, "#define N %u\n#define M %u\n\n", N, M);
+    fprintf(out, "// structural patterns\n");
+    fprintf(out, "static char const F[N][N + 1] = {");
+    for (r = 0; r < N; r++)
+    {
+        fprintf(out, " \"%.*s\",", N, m->F[r]);
+    }
+    fprintf(out, " };\nstatic char const H[M][N + 1] = {");
+    for (r = 0; r < M; r++)
+    {
+        fprintf(out, " \"%.*s\",", N, m->H[r]);
+    }
+    fprintf(out, " };\nstatic char const Qp[N][N + 1] = {");
+    for (r = 0; r < N; r++)
+    {
+        fprintf(out, " \"%.*s\",", N, m->Q[r]);
+    }
+    fprintf(out, " };\nstatic char const Rp[M][M + 1] = {");
+    for (r = 0; r < M; r++)
+    {
+        fprintf(out, " \"%.*s\",", M, m->R[r]);
+    }
+    fprintf(out, " };\n\n");
+    fprintf(out, "// random values of the non structural entries\n"
+            "static eekf_value Fv[N][N], Hv[M][N];\n\n");
+
+    fputs(
+            "static eekf_value pattern_value(char p, eekf_value v)\n"
+            "{\n"
+            "    return '0' == p ? 0 : '1' == p ? 1 : v;\n"
+            "}\n"
+            "\n"
+            "// linear model xp = Jf * x with the structural pattern of Jf\n"
+            "static eekf_return f(eekf_mat *xp, eekf_mat *Jf, eekf_mat const *x,\n"
+            "        eekf_mat const *u, void *userData)\n"
+            "{\n"
+            "    int r, c;\n"
+            "    for (r = 0; r < N; r++)\n"
+            "    {\n"
+            "        for (c = 0; c < N; c++)\n"
+            "        {\n"
+            "            *EEKF_MAT_EL(*Jf, r, c) = pattern_value(F[r][c], Fv[r][c]);\n"
+            "        }\n"
+            "    }\n"
+            "    return NULL == eekf_mat_mul(xp, Jf, x) ? eEekfReturnComputationFailed\n"
+            "            : eEekfReturnOk;\n"
+            "}\n"
+            "\n"
+            "// linear measurement zp = Jh * x with the structural pattern of Jh\n"
+            "static eekf_return h(eekf_mat *zp, eekf_mat *Jh, eekf_mat const *x,\n"
+            "        void *userData)\n"
+            "{\n"
+            "    int r, c;\n"
+            "    for (r = 0; r < M; r++)\n"
+            "    {\n"
+            "        for (c = 0; c < N; c++)\n"
+            "        {\n"
+            "            *EEKF_MAT_EL(*Jh, r, c) = pattern_value(H[r][c], Hv[r][c]);\n"
+            "        }\n"
+            "    }\n"
+            "    return NULL == eekf_mat_mul(zp, Jh, x) ? eEekfReturnComputationFailed\n"
+            "            : eEekfReturnOk;\n"
+            "}\n"
+            "\n"
+            "// random symmetric positive definite matrix with given pattern\n"
+            "static void random_cov(eekf_mat *A, char const *p, int stride)\n"
+            "{\n"
+            "    int r, c;\n"
+            "    for (r = 0; r < A->rows; r++)\n"
+            "    {\n"
+            "        for (c = r; c < A->cols; c++)\n"
+            "        {\n"
+            "            eekf_value v = 'x' != p[r * stride + c] ? 0\n"
+            "                    : r == c ? 1 + (eekf_value) rand() / RAND_MAX\n"
+            "                    : 0.1 * ((eekf_value) rand() / RAND_MAX - 0.5) / A->rows;\n"
+            "            *EEKF_MAT_EL(*A, r, c) = v;\n"
+            "            *EEKF_MAT_EL(*A, c, r) = v;\n"
+            "        }\n"
+            "    }\n"
+            "}\n"
+            "\n"
+            "static eekf_value max_diff(eekf_mat const *A, eekf_mat const *B)\n"
+            "{\n"
+            "    eekf_value d = 0;\n"
+            "    int r, c;\n"
+            "    for (r = 0; r < A->rows; r++)\n"
+            "    {\n"
+            "        for (c = 0; c < A->cols; c++)\n"
+            "        {\n"
+            "            eekf_value a = *EEKF_MAT_EL(*A, r, c), b = *EEKF_MAT_EL(*B, r, c);\n"
+            "            d = fmax(d, fabs(a - b) / fmax(1, fabs(a)));\n"
+            "        }\n"
+            "    }\n"
+            "    return d;\n"
+            "}\n"
+            "\n"
+            "int main(int argc, char **argv)\n"
+            "{\n"
+            "    eekf_context generic, generated;\n"
+            "    EEKF_DECL_MAT(x1, N, 1);\n"
+            "    EEKF_DECL_MAT(P1, N, N);\n"
+            "    EEKF_DECL_MAT(x2, N, 1);\n"
+            "    EEKF_DECL_MAT(P2, N, N);\n"
+            "    EEKF_DECL_MAT(Q, N, N);\n"
+            "    EEKF_DECL_MAT(R, M, M);\n"
+            "    EEKF_DECL_MAT(z, M, 1);\n"
+            "    EEKF_DECL_MAT(u, 1, 1);\n"
+            "    eekf_value d = 0;\n"
+            "    int r, c, k;\n"
+            "\n"
+            "    srand(0);\n"
+            "    for (r = 0; r < N; r++)\n"
+            "    {\n"
+            "        for (c = 0; c < N; c++)\n"
+            "        {\n"
+            "            Fv[r][c] = (eekf_value) rand() / RAND_MAX - 0.5;\n"
+            "        }\n"
+            "        *EEKF_MAT_EL(x1, r, 0) = eekf_randn();\n"
+            "        *EEKF_MAT_EL(P1, r, r) = 1;\n"
+            "    }\n"
+            "    for (r = 0; r < M; r++)\n"
+            "    {\n"
+            "        for (c = 0; c < N; c++)\n"
+            "        {\n"
+            "            Hv[r][c] = (eekf_value) rand() / RAND_MAX - 0.5;\n"
+            "        }\n"
+            "    }\n"
+            "    random_cov(&Q, Qp[0], N + 1);\n"
+            "    random_cov(&R, Rp[0], M + 1);\n"
+            "    memcpy(x2_elements, x1_elements, sizeof(x1_elements));\n"
+            "    memcpy(P2_elements, P1_elements, sizeof(P1_elements));\n"
+            "\n"
+            "    eekf_init(&generic, &x1, &P1, f, h, NULL);\n"
+            "    eekf_init(&generated, &x2, &P2, f, h, NULL);\n"
+            "\n"
+            "    for (k = 0; k < 100; k++)\n"
+            "    {\n"
+            "        for (r = 0; r < M; r++)\n"
+            "        {\n"
+            "            *EEKF_MAT_EL(z, r, 0) = eekf_randn();\n"
+            "        }\n"
+            "        if (eEekfReturnOk != eekf_predict(&generic, &u, &Q)\n"
+            "                || eEekfReturnOk != eekf_correct(&generic, &z, &R))\n"
+            "        {\n"
+            "            printf(\"generic filter failed at step %d\\n\", k);\n"
+            "            return 1;\n"
+            "        }\n", out);
+    fprintf(out,
+            "        if (eEekfReturnOk != %s_predict(&generated, &u, &Q)\n"
+            "                || eEekfReturnOk != %s_correct(&generated, &z, &R))\n",
+            m->name, m->name);
+    fputs(
+            "        {\n"
+            "            printf(\"generated filter failed at step %d\\n\", k);\n"
+            "            return 1;\n"
+            "        }\n"
+            "        d = fmax(d, fmax(max_diff(&x1, &x2), max_diff(&P1, &P2)));\n"
+            "    }\n"
+            "\n"
+            "    printf(\"maximum relative deviation %g: %s\\n\", d,\n"
+            "            d < 1e-9 ? \"passed\" : \"FAILED\");\n"
+            "    return d < 1e-9 ? 0 : 1;\n"
+            "}\n", out);
+}
+
+// open an output file in dir
+static FILE* eekf_gen_open(char const *dir, char const *name,
+        char const *suffix)
+{
+    char path[512];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s/%s%s", dir, name, suffix);
+    if (NULL == (f = fopen(path, "w+")))
+    {
+        fprintf(stderr, "eekf_gen: cannot write %s\n", path);
+    }
+
+    return f;
+}
+
+int main(int argc, char **argv)
+{
+    char const *dir = ".";
+    char const *file = NULL;
+    int check = 0;
+    int i;
+    eekf_gen_model m;
+    FILE *in, *out;
+    char guard[80];
+
+    for (i = 1; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "-t"))
+        {
+            check = 1;
+        }
+        else if (0 == strcmp(argv[i], "-o") && i + 1 < argc)
+        {
+            dir = argv[++i];
+        }
+        else
+        {
+            file = argv[i];
+        }
+    }
+    if (NULL == file)
+    {
+        fprintf(stderr, "usage: eekf_gen [-t] [-o outdir] model\n");
+        return 2;
+    }
+
+    if (NULL == (in = fopen(file, "r")))
+    {
+        fprintf(stderr, "eekf_gen: cannot read %s\n", file);
+        return 1;
+    }
+    i = eekf_gen_parse(&m, in);
+    fclose(in);
+    if (!i)
+    {
+        return 1;
+    }
+
+    for (i = 0; m.name[i] && i + 1 < (int) sizeof(guard); i++)
+    {
+        guard[i] = m.name[i] >= 'a' && m.name[i] <= 'z' ?
+                m.name[i] - 'a' + 'A' : m.name[i];
+    }
+    guard[i] = 0;
+
+    if (NULL == (out = eekf_gen_open(dir, m.name, ".h")))
+    {
+        return 1;
+    }
+    eekf_gen_emit_header(out, &m, guard);
+    fclose(out);
+
+    if (NULL == (out = eekf_gen_open(dir, m.name, ".c")))
+    {
+        return 1;
+    }
+    eekf_gen_emit_source(out, &m);
+    fclose(out);
+
+    if (check)
+    {
+        if (NULL == (out = eekf_gen_open(dir, m.name, "_check.c")))
+        {
+            return 1;
+        }
+        eekf_gen_emit_check(out, &m);
+        fclose(out);
+    }
+
+    return 0;
+}
@@ -1,7 +1,14 @@
 CC = gcc
 AR = ar rcs
 RM = rm -f
+HOST_CC = gcc
 
 CFLAGS += -Wall -O2 -std=gnu99
 CFLAGS += $(foreach includedir,$(INCLUDE_DIRS),-I$(includedir))
-LDFLAGS += -lm
\ No newline at end of file
+LDFLAGS += -lm
+
+# flags of the thread based host library and the programs linking it
+PTHREAD_CFLAGS += -pthread
+PTHREAD_LDFLAGS += -pthread
+
+HOST_CFLAGS += -Wall -O2 -std=gnu99
\ No newline at end of file